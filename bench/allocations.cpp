@@ -0,0 +1,80 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "bench.h"
+#include "synthetic_pe.h"
+#include "manape/pe.h"
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Parses every directory of a PE and reports how many heap allocations and
+ *			how much time it took.
+ *
+ *	@param	bool pooled Whether the parsed structures are placed in the PE's arena, or
+ *			allocated one by one with boost::make_shared (the baseline).
+ */
+void measure(const std::string& what, const shared_bytes& bytes, bool pooled)
+{
+	const std::string mode = pooled ? " (arena)" : " (make_shared)";
+	mana::pe::parse_limits limits;
+	limits.use_arena = pooled;
+	auto parse = [&bytes, &limits]() {
+		return mana::pe::PE::from_memory(bytes, "", mana::pe::PE::FULL, limits);
+	};
+
+	size_t before = bench::allocation_count();
+	{
+		auto pe = parse();
+		bench::keep(pe->get_sections()->size());
+		bench::keep(pe->get_imports()->size());
+		bench::keep(pe->get_exports()->size());
+		bench::keep(pe->get_resources()->size());
+		bench::keep(pe->get_relocation_table()->size());
+		bench::keep(pe->get_debug_info()->size());
+	}
+	bench::report(what + ", allocations" + mode, static_cast<double>(bench::allocation_count() - before), "");
+
+	double t = bench::time_it([&parse]() {
+		auto pe = parse();
+		bench::keep(pe->get_imports()->size());
+		bench::keep(pe->get_exports()->size());
+		bench::keep(pe->get_resources()->size());
+	});
+	bench::report(what + ", time" + mode, t * 1000, "ms");
+}
+
+// ----------------------------------------------------------------------------
+
+void compare(const std::string& what, const shared_bytes& bytes)
+{
+	measure(what, bytes, false);
+	measure(what, bytes, true);
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Counts the heap allocations needed to parse PEs with large directories, which is
+ *	what dominates batch scans of many files. Each PE is parsed with and without the
+ *	arena, so that both numbers can be compared.
+ */
+BENCHMARK(allocations)
+{
+	compare("10k imports", bench::make_import_exe(10000));
+	compare("50k exports", bench::make_export_dll(50000));
+	compare("20k resources", bench::make_resource_exe(20000));
+}
@@ -0,0 +1,87 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <random>
+
+#include "bench.h"
+#include "manape/utils.h"
+
+namespace {
+
+/**
+ *	@brief	The straightforward histogram, for comparison.
+ */
+void naive_histogram(const boost::uint8_t* data, size_t size, boost::uint64_t* histogram)
+{
+	std::fill(histogram, histogram + 256, 0);
+	for (size_t i = 0 ; i < size ; ++i) {
+		++histogram[data[i]];
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void measure(const std::string& what, const std::vector<boost::uint8_t>& bytes)
+{
+	boost::uint64_t histogram[256];
+	const double gigabytes = bytes.size() / 1e9;
+
+	double t = bench::time_it([&bytes, &histogram]() {
+		naive_histogram(bytes.data(), bytes.size(), histogram);
+		bench::keep(histogram[0]);
+	});
+	bench::report(what + ", naive histogram", gigabytes / t, "GB/s");
+
+	t = bench::time_it([&bytes, &histogram]() {
+		mana::utils::byte_histogram(bytes.data(), bytes.size(), histogram);
+		bench::keep(histogram[0]);
+	});
+	bench::report(what + ", byte_histogram", gigabytes / t, "GB/s");
+
+	t = bench::time_it([&bytes]() {
+		bench::keep(mana::utils::shannon_entropy(bytes.data(), bytes.size()));
+	});
+	bench::report(what + ", shannon_entropy", gigabytes / t, "GB/s");
+}
+
+} // !namespace
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Computes the entropy of 64 MB buffers with different contents: random bytes (packed
+ *	data), zeroes (uninitialized data) and alternating 4 KB blocks of both, which
+ *	resembles the content of most sections.
+ */
+BENCHMARK(entropy)
+{
+	const size_t SIZE = 64 << 20;
+	std::mt19937 rng(0);
+	std::vector<boost::uint8_t> random(SIZE);
+	for (auto& b : random) {
+		b = static_cast<boost::uint8_t>(rng());
+	}
+	std::vector<boost::uint8_t> zeroes(SIZE, 0);
+	std::vector<boost::uint8_t> mixed(random);
+	for (size_t i = 0 ; i < SIZE ; i += 8192) {
+		std::fill(mixed.begin() + i, mixed.begin() + i + 4096, 0);
+	}
+
+	measure("random", random);
+	measure("zeroes", zeroes);
+	measure("mixed", mixed);
+}
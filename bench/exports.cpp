@@ -0,0 +1,72 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "bench.h"
+#include "synthetic_pe.h"
+#include "manape/pe.h"
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Looks up exports by name and by ordinal in a DLL exporting 50.000 functions, the
+ *	way plugins query specific functions of large system DLLs.
+ */
+BENCHMARK(exports)
+{
+	const unsigned int EXPORTS = 50000;
+	auto pe = mana::pe::PE::from_memory(bench::make_export_dll(EXPORTS));
+	auto exports = pe->get_exports();
+
+	std::vector<std::string> names;
+	for (unsigned int i = 0 ; i < EXPORTS ; i += 97) {
+		names.push_back(exports->at(i)->Name);
+	}
+
+	double t = bench::time_it([&exports, &names]() {
+		unsigned int sum = 0;
+		for (const auto& name : names)
+		{
+			for (const auto& ex : *exports)
+			{
+				if (ex->Name == name)
+				{
+					sum += ex->Ordinal;
+					break;
+				}
+			}
+		}
+		bench::keep(sum);
+	});
+	bench::report("scan get_exports() by name", t * 1e9 / names.size(), "ns/lookup");
+
+	t = bench::time_it([&pe, &names]() {
+		unsigned int sum = 0;
+		for (const auto& name : names) {
+			sum += pe->find_export(name)->Ordinal;
+		}
+		bench::keep(sum);
+	});
+	bench::report("find_export by name", t * 1e9 / names.size(), "ns/lookup");
+
+	t = bench::time_it([&pe]() {
+		unsigned int sum = 0;
+		for (boost::uint32_t ordinal = 1 ; ordinal <= EXPORTS ; ++ordinal) {
+			sum += pe->find_export(ordinal)->Address;
+		}
+		bench::keep(sum);
+	});
+	bench::report("find_export by ordinal", t * 1e9 / EXPORTS, "ns/lookup");
+}
@@ -0,0 +1,50 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "synthetic_pe.h"
+#include "manape/pe.h"
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Reconstructs every icon of a PE containing 5.000 icon groups, the way --extract
+ *	does. Each group references an RT_ICON which has to be located among the resources.
+ */
+BENCHMARK(icons)
+{
+	auto bytes = bench::make_icon_exe(5000);
+	auto pe = mana::pe::PE::from_memory(bytes);
+	auto resources = pe->get_resources();
+	std::vector<mana::pe::pgroup_icon_directory> groups;
+	for (const auto& r : *resources)
+	{
+		if (*r->get_type() == "RT_GROUP_ICON") {
+			groups.push_back(r->interpret_as<mana::pe::pgroup_icon_directory>());
+		}
+	}
+
+	double t = bench::time_it([&resources, &groups]() {
+		size_t total = 0;
+		mana::pe::IconIndex index(*resources);
+		for (const auto& g : groups) {
+			total += mana::pe::reconstruct_icon(g, index)->size();
+		}
+		bench::keep(total);
+	});
+	bench::report("reconstruct 5k icons", t * 1000, "ms");
+}
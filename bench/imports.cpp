@@ -0,0 +1,47 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "synthetic_pe.h"
+#include "manape/pe.h"
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Parses an import table containing 10.000 entries, which is the largest table
+ *	Manalyze accepts. Every entry has to be checked against the previous ones to
+ *	detect loops.
+ */
+BENCHMARK(imports)
+{
+	const unsigned int IMPORTS = 10000;
+
+	auto by_name = bench::make_import_exe(IMPORTS, true);
+	double t = bench::time_it([&by_name]() {
+		auto pe = mana::pe::PE::from_memory(by_name);
+		bench::keep(pe->get_imports()->at(0)->get_imports()->size());
+	});
+	bench::report("parse 10k imports by name", t * 1000, "ms");
+
+	// Without the Hint/Name tables, most of the time is spent on the table itself.
+	auto by_ordinal = bench::make_import_exe(IMPORTS, false);
+	t = bench::time_it([&by_ordinal]() {
+		auto pe = mana::pe::PE::from_memory(by_ordinal);
+		bench::keep(pe->get_imports()->at(0)->get_imports()->size());
+	});
+	bench::report("parse 10k imports by ordinal", t * 1000, "ms");
+}
@@ -0,0 +1,113 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+typedef void (*bench_function)();
+
+/**
+ *	@brief	Returns the list of benchmarks compiled into the executable.
+ */
+std::vector<std::pair<std::string, bench_function>>& get_benchmarks();
+
+/**
+ *	@brief	Registers a benchmark at static initialization time. Use the BENCHMARK
+ *			macro instead of instantiating this class directly.
+ */
+class Registrar
+{
+public:
+	Registrar(const std::string& name, bench_function f) {
+		get_benchmarks().push_back(std::make_pair(name, f));
+	}
+};
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Measures the duration of a function.
+ *
+ *	@param	F f The function to time.
+ *	@param	unsigned int repeat How many times the measurement is performed. The best
+ *			run is kept, to filter out noise.
+ *
+ *	@return	The duration of the fastest run, in seconds.
+ */
+template<class F>
+double time_it(F f, unsigned int repeat = 5)
+{
+	double best = -1;
+	for (unsigned int i = 0 ; i < repeat ; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		f();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		best = best < 0 ? elapsed.count() : std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Prints a measurement.
+ *
+ *	@param	const std::string& what A description of what was measured.
+ *	@param	double value The measured value.
+ *	@param	const std::string& unit The unit of the value.
+ */
+inline void report(const std::string& what, double value, const std::string& unit) {
+	std::cout << "    " << what << ": " << value << " " << unit << std::endl;
+}
+
+/**
+ *	@brief	Returns the number of heap allocations performed by the program so far.
+ *			They are counted by the replacement operator new defined in main.cpp.
+ */
+size_t allocation_count();
+
+/**
+ *	@brief	Prevents the compiler from optimizing away a computation whose result is
+ *			not used otherwise.
+ */
+template<class T>
+void keep(const T& value) {
+#if defined _MSC_VER
+	static const void* volatile sink;
+	sink = &value;
+	(void) sink;
+#else
+	// Tells the compiler that the value is read, without generating any instruction.
+	asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+} // !namespace bench
+
+#define BENCHMARK(name)													\
+	static void name();													\
+	static bench::Registrar name##_registrar(#name, name);				\
+	static void name()
@@ -0,0 +1,422 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/make_shared.hpp>
+
+#include "types.h"
+
+namespace bench {
+
+/**
+ *	@brief	Generates minimal PE32 files in memory, so that benchmarks do not depend
+ *			on samples which cannot be distributed.
+ *
+ *	The generated image contains a number of empty code sections, followed by a single
+ *	data section in which the benchmarks place the structures they need (exports,
+ *	imports, ...) and point the data directories to.
+ */
+class SyntheticPE
+{
+public:
+	static const boost::uint32_t FILE_ALIGNMENT = 0x200;
+	static const boost::uint32_t SECTION_ALIGNMENT = 0x1000;
+
+	/**
+	 *	@param	unsigned int code_sections The number of empty sections preceding the
+	 *			data section. There is always at least one.
+	 */
+	explicit SyntheticPE(unsigned int code_sections = 1)
+		: _code_sections(std::max(code_sections, 1u)), _directories(16 * 2, 0) {}
+
+	/**
+	 *	@brief	Returns the RVA of the first code section, which exported functions or
+	 *			entry points can point to.
+	 */
+	boost::uint32_t code_rva() const { return SECTION_ALIGNMENT; }
+
+	/**
+	 *	@brief	Returns the RVA of the data section.
+	 */
+	boost::uint32_t data_rva() const { return SECTION_ALIGNMENT * (_code_sections + 1); }
+
+	/**
+	 *	@brief	Returns the RVA at which the next appended bytes will be located.
+	 */
+	boost::uint32_t next_rva() const { return data_rva() + static_cast<boost::uint32_t>(_data.size()); }
+
+	/**
+	 *	@brief	Appends bytes to the data section.
+	 *
+	 *	@return	The RVA of the appended bytes.
+	 */
+	boost::uint32_t append(const void* data, size_t size)
+	{
+		boost::uint32_t rva = next_rva();
+		const boost::uint8_t* p = static_cast<const boost::uint8_t*>(data);
+		_data.insert(_data.end(), p, p + size);
+		return rva;
+	}
+
+	boost::uint32_t append_u16(boost::uint16_t value) { return append(&value, sizeof(value)); }
+	boost::uint32_t append_u32(boost::uint32_t value) { return append(&value, sizeof(value)); }
+	boost::uint32_t append_string(const std::string& s) { return append(s.c_str(), s.size() + 1); }
+
+	/**
+	 *	@brief	Overwrites a 32 bit value which was previously appended.
+	 */
+	void patch_u32(boost::uint32_t rva, boost::uint32_t value) {
+		memcpy(&_data[rva - data_rva()], &value, sizeof(value));
+	}
+
+	void set_directory(unsigned int index, boost::uint32_t rva, boost::uint32_t size)
+	{
+		_directories[index * 2] = rva;
+		_directories[index * 2 + 1] = size;
+	}
+
+	/**
+	 *	@brief	Assembles the headers and the sections into a PE file.
+	 */
+	shared_bytes build() const
+	{
+		const unsigned int number_of_sections = _code_sections + 1;
+		const boost::uint32_t section_table = 0x40 + 4 + 20 + 0xE0;
+		const boost::uint32_t size_of_headers = _align(section_table + 40 * number_of_sections, FILE_ALIGNMENT);
+		const boost::uint32_t data_raw_size = _align(static_cast<boost::uint32_t>(_data.size()), FILE_ALIGNMENT);
+		const boost::uint32_t data_pointer = size_of_headers + _code_sections * FILE_ALIGNMENT;
+
+		auto res = boost::make_shared<std::vector<boost::uint8_t>>(data_pointer + data_raw_size, 0);
+		std::vector<boost::uint8_t>& out = *res;
+
+		// DOS header
+		out[0] = 'M';
+		out[1] = 'Z';
+		_put32(out, 0x3C, 0x40);
+
+		// PE header
+		memcpy(&out[0x40], "PE\0\0", 4);
+		_put16(out, 0x44, 0x14C);						// Machine: i386
+		_put16(out, 0x46, number_of_sections);
+		_put16(out, 0x54, 0xE0);						// SizeOfOptionalHeader
+		_put16(out, 0x56, 0x2102);						// Executable, 32 bit, DLL
+
+		// Image optional header
+		const boost::uint32_t ioh = 0x58;
+		_put16(out, ioh, 0x10B);						// PE32
+		_put32(out, ioh + 0x10, code_rva());			// AddressOfEntryPoint
+		_put32(out, ioh + 0x1C, 0x10000000);			// ImageBase
+		_put32(out, ioh + 0x20, SECTION_ALIGNMENT);
+		_put32(out, ioh + 0x24, FILE_ALIGNMENT);
+		_put32(out, ioh + 0x38, data_rva() + _align(data_raw_size, SECTION_ALIGNMENT)); // SizeOfImage
+		_put32(out, ioh + 0x3C, size_of_headers);
+		_put16(out, ioh + 0x44, 2);						// Subsystem: GUI
+		_put32(out, ioh + 0x5C, 16);					// NumberOfRvaAndSizes
+		for (unsigned int i = 0 ; i < _directories.size() ; ++i) {
+			_put32(out, ioh + 0x60 + 4 * i, _directories[i]);
+		}
+
+		// Section table
+		for (unsigned int i = 0 ; i < number_of_sections ; ++i)
+		{
+			boost::uint32_t header = section_table + 40 * i;
+			bool is_data = (i == _code_sections);
+			char name[16]; // Fits any %u; Name only keeps the first 8 bytes.
+			snprintf(name, sizeof(name), is_data ? ".data" : ".text%u", i);
+			memcpy(&out[header], name, std::min<size_t>(strlen(name), 8));
+			_put32(out, header + 8, is_data ? std::max(data_raw_size, FILE_ALIGNMENT) : SECTION_ALIGNMENT);
+			_put32(out, header + 12, SECTION_ALIGNMENT * (i + 1));
+			_put32(out, header + 16, is_data ? data_raw_size : FILE_ALIGNMENT);
+			_put32(out, header + 20, size_of_headers + i * FILE_ALIGNMENT);
+			_put32(out, header + 36, is_data ? 0xC0000040 : 0x60000020);
+		}
+
+		if (!_data.empty()) {
+			memcpy(&out[data_pointer], &_data[0], _data.size());
+		}
+		return res;
+	}
+
+private:
+	static boost::uint32_t _align(boost::uint32_t value, boost::uint32_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+	static void _put16(std::vector<boost::uint8_t>& out, size_t offset, boost::uint16_t value) {
+		memcpy(&out[offset], &value, sizeof(value));
+	}
+	static void _put32(std::vector<boost::uint8_t>& out, size_t offset, boost::uint32_t value) {
+		memcpy(&out[offset], &value, sizeof(value));
+	}
+
+	unsigned int _code_sections;
+	std::vector<boost::uint32_t> _directories;
+	std::vector<boost::uint8_t> _data;
+};
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Generates a DLL exporting a large number of functions by name.
+ *
+ *	@param	unsigned int exports The number of exported functions.
+ *	@param	unsigned int code_sections The number of sections preceding the export
+ *			directory, which makes section lookups more expensive.
+ */
+inline shared_bytes make_export_dll(unsigned int exports, unsigned int code_sections = 1)
+{
+	SyntheticPE pe(code_sections);
+
+	// IMAGE_EXPORT_DIRECTORY. The RVAs are filled in once the tables are written.
+	boost::uint32_t ied = pe.next_rva();
+	boost::uint32_t zeros[10] = { 0 };
+	pe.append(zeros, sizeof(zeros));
+	pe.patch_u32(ied + 16, 1);							// Base
+	pe.patch_u32(ied + 20, exports);					// NumberOfFunctions
+	pe.patch_u32(ied + 24, exports);					// NumberOfNames
+	pe.patch_u32(ied + 12, pe.append_string("synthetic.dll"));
+
+	pe.patch_u32(ied + 28, pe.next_rva());				// AddressOfFunctions
+	for (unsigned int i = 0 ; i < exports ; ++i) {
+		pe.append_u32(pe.code_rva() + i % SyntheticPE::SECTION_ALIGNMENT);
+	}
+	boost::uint32_t names = pe.next_rva();
+	pe.patch_u32(ied + 32, names);						// AddressOfNames
+	for (unsigned int i = 0 ; i < exports ; ++i) {
+		pe.append_u32(0);
+	}
+	pe.patch_u32(ied + 36, pe.next_rva());				// AddressOfNameOrdinals
+	for (unsigned int i = 0 ; i < exports ; ++i) {
+		pe.append_u16(static_cast<boost::uint16_t>(i));
+	}
+	for (unsigned int i = 0 ; i < exports ; ++i)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "ExportedFunction%07u", i);
+		pe.patch_u32(names + 4 * i, pe.append_string(name));
+	}
+
+	pe.set_directory(0, ied, pe.next_rva() - ied);		// IMAGE_DIRECTORY_ENTRY_EXPORT
+	return pe.build();
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Generates an executable importing a large number of functions from a
+ *			single DLL.
+ *
+ *	@param	unsigned int imports The number of imported functions.
+ *	@param	bool by_name Whether the functions are imported by name or by ordinal.
+ */
+inline shared_bytes make_import_exe(unsigned int imports, bool by_name = true)
+{
+	SyntheticPE pe;
+
+	// One IMAGE_IMPORT_DESCRIPTOR, followed by the NULL one ending the list.
+	boost::uint32_t iid = pe.next_rva();
+	boost::uint32_t zeros[10] = { 0 };
+	pe.append(zeros, sizeof(zeros));
+	pe.patch_u32(iid + 12, pe.append_string("synthetic.dll"));		// Name
+
+	boost::uint32_t ilt = pe.next_rva();
+	pe.patch_u32(iid, ilt);										// OriginalFirstThunk
+	pe.patch_u32(iid + 16, ilt);								// FirstThunk
+	for (unsigned int i = 0 ; i <= imports ; ++i) {
+		pe.append_u32(0);
+	}
+	for (unsigned int i = 0 ; i < imports ; ++i)
+	{
+		if (!by_name)
+		{
+			pe.patch_u32(ilt + 4 * i, 0x80000000 | (i + 1));
+			continue;
+		}
+		char name[32];
+		snprintf(name, sizeof(name), "ImportedFunction%07u", i);
+		boost::uint32_t hint_name = pe.append_u16(static_cast<boost::uint16_t>(i));
+		pe.append_string(name);
+		if (pe.next_rva() % 2) {
+			pe.append("", 1);										// Hint/Name entries are aligned
+		}
+		pe.patch_u32(ilt + 4 * i, hint_name);
+	}
+
+	pe.set_directory(1, iid, 40);								// IMAGE_DIRECTORY_ENTRY_IMPORT
+	return pe.build();
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Generates an executable containing a large number of RT_STRING resources,
+ *			like the string tables of localized installers.
+ *
+ *	@param	unsigned int resources The number of resources (at most 65535).
+ */
+inline shared_bytes make_resource_exe(unsigned int resources)
+{
+	SyntheticPE pe;
+	const boost::uint32_t SUBDIRECTORY = 0x80000000;
+	const boost::uint32_t zeros[4] = { 0 };
+
+	// Appends an IMAGE_RESOURCE_DIRECTORY followed by room for its entries.
+	auto directory = [&pe](unsigned int entries) -> boost::uint32_t {
+		boost::uint32_t header[4] = { 0, 0, 0, entries << 16 };	// NumberOfIdEntries
+		boost::uint32_t rva = pe.append(header, sizeof(header));
+		for (unsigned int i = 0 ; i < 2 * entries ; ++i) {
+			pe.append_u32(0);
+		}
+		return rva;
+	};
+
+	// Root -> RT_STRING -> resource ID -> language -> IMAGE_RESOURCE_DATA_ENTRY.
+	boost::uint32_t root = directory(1);
+	boost::uint32_t types = directory(resources);
+	pe.patch_u32(root + 16, 6);									// RT_STRING
+	pe.patch_u32(root + 20, SUBDIRECTORY | (types - root));
+	for (unsigned int i = 0 ; i < resources ; ++i)
+	{
+		boost::uint32_t languages = directory(1);
+		pe.patch_u32(types + 16 + 8 * i, i + 1);
+		pe.patch_u32(types + 20 + 8 * i, SUBDIRECTORY | (languages - root));
+
+		boost::uint32_t data_entry = pe.append(zeros, sizeof(zeros));
+		pe.patch_u32(languages + 16, 1033);						// en-US
+		pe.patch_u32(languages + 20, data_entry - root);
+
+		boost::uint32_t data = pe.append_u32(i);
+		pe.append_u32(0);
+		pe.patch_u32(data_entry, data);
+		pe.patch_u32(data_entry + 4, 8);						// Size
+	}
+
+	pe.set_directory(2, root, pe.next_rva() - root);			// IMAGE_DIRECTORY_ENTRY_RESOURCE
+	return pe.build();
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Generates an executable containing many single-image icons: each
+ *			RT_GROUP_ICON references one RT_ICON with the same ID.
+ *
+ *	@param	unsigned int icons The number of icons (at most 65535).
+ */
+inline shared_bytes make_icon_exe(unsigned int icons)
+{
+	SyntheticPE pe;
+	const boost::uint32_t SUBDIRECTORY = 0x80000000;
+	const boost::uint32_t zeros[4] = { 0 };
+
+	auto directory = [&pe](unsigned int entries) -> boost::uint32_t {
+		boost::uint32_t header[4] = { 0, 0, 0, entries << 16 };	// NumberOfIdEntries
+		boost::uint32_t rva = pe.append(header, sizeof(header));
+		for (unsigned int i = 0 ; i < 2 * entries ; ++i) {
+			pe.append_u32(0);
+		}
+		return rva;
+	};
+
+	// Root -> type -> resource ID -> language -> IMAGE_RESOURCE_DATA_ENTRY.
+	boost::uint32_t root = directory(2);
+	const boost::uint32_t type_ids[2] = { 3, 14 };				// RT_ICON, RT_GROUP_ICON
+	for (unsigned int t = 0 ; t < 2 ; ++t)
+	{
+		boost::uint32_t ids = directory(icons);
+		pe.patch_u32(root + 16 + 8 * t, type_ids[t]);
+		pe.patch_u32(root + 20 + 8 * t, SUBDIRECTORY | (ids - root));
+		for (unsigned int i = 0 ; i < icons ; ++i)
+		{
+			boost::uint32_t languages = directory(1);
+			pe.patch_u32(ids + 16 + 8 * i, i + 1);
+			pe.patch_u32(ids + 20 + 8 * i, SUBDIRECTORY | (languages - root));
+
+			boost::uint32_t data_entry = pe.append(zeros, sizeof(zeros));
+			pe.patch_u32(languages + 16, 1033);					// en-US
+			pe.patch_u32(languages + 20, data_entry - root);
+
+			boost::uint32_t data;
+			if (type_ids[t] == 3) {								// 64 bytes of image data
+				data = pe.append_u32(i);
+				for (unsigned int j = 1 ; j < 16 ; ++j) {
+					pe.append_u32(0);
+				}
+			}
+			else
+			{
+				data = pe.append_u16(0);						// Reserved
+				pe.append_u16(1);								// Type: icon
+				pe.append_u16(1);								// Count
+				pe.append_u32(0x00001010);						// 16x16, no palette
+				pe.append_u16(1);								// Planes
+				pe.append_u16(32);								// BitCount
+				pe.append_u32(64);								// BytesInRes
+				pe.append_u16(static_cast<boost::uint16_t>(i + 1));	// RT_ICON ID
+			}
+			pe.patch_u32(data_entry, data);
+			pe.patch_u32(data_entry + 4, pe.next_rva() - data);	// Size
+			while (pe.next_rva() % 4) {
+				pe.append("", 1);
+			}
+		}
+	}
+
+	pe.set_directory(2, root, pe.next_rva() - root);			// IMAGE_DIRECTORY_ENTRY_RESOURCE
+	return pe.build();
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Generates a hostile executable whose resource directories all point to the
+ *			same subdirectory. A few kilobytes describe a tree of entries^3 resources.
+ *
+ *	@param	unsigned int entries The number of entries of each directory.
+ */
+inline shared_bytes make_resource_loop_exe(unsigned int entries)
+{
+	SyntheticPE pe;
+	const boost::uint32_t SUBDIRECTORY = 0x80000000;
+	const boost::uint32_t header[4] = { 0, 0, 0, entries << 16 };	// NumberOfIdEntries
+	const boost::uint32_t subdirectory = sizeof(header) + 8 * entries;
+
+	boost::uint32_t root = pe.append(header, sizeof(header));
+	for (unsigned int i = 0 ; i < entries ; ++i)
+	{
+		pe.append_u32(i + 1);
+		pe.append_u32(SUBDIRECTORY | subdirectory);
+	}
+	pe.append(header, sizeof(header));
+	for (unsigned int i = 0 ; i < entries ; ++i)
+	{
+		pe.append_u32(i + 1);
+		pe.append_u32(SUBDIRECTORY | subdirectory);
+	}
+
+	pe.set_directory(2, root, pe.next_rva() - root);			// IMAGE_DIRECTORY_ENTRY_RESOURCE
+	return pe.build();
+}
+
+} // !namespace bench
@@ -0,0 +1,92 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "bench.h"
+
+namespace {
+	std::atomic<size_t> allocations(0);
+}
+
+// Replacing these operators also affects the allocations made inside manape.
+void* operator new(size_t size)
+{
+	++allocations;
+	void* p = malloc(size == 0 ? 1 : size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+	free(p);
+}
+
+namespace bench {
+
+std::vector<std::pair<std::string, bench_function>>& get_benchmarks()
+{
+	static std::vector<std::pair<std::string, bench_function>> benchmarks;
+	return benchmarks;
+}
+
+size_t allocation_count() {
+	return allocations;
+}
+
+} // !namespace bench
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Usage: manalyze-bench [benchmark names...]
+ *	Runs the given benchmarks, or all of them if no name is specified.
+ */
+int main(int argc, char** argv)
+{
+	std::vector<std::string> selected(argv + 1, argv + argc);
+	for (const auto& it : bench::get_benchmarks())
+	{
+		if (!selected.empty() &&
+			std::find(selected.begin(), selected.end(), it.first) == selected.end()) {
+			continue;
+		}
+		std::cout << it.first << std::endl;
+		it.second();
+	}
+	return 0;
+}
@@ -0,0 +1,45 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "synthetic_pe.h"
+#include "manape/pe.h"
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Parses the resource tree of a PE containing 20.000 string tables. Each resource
+ *	has to be checked against the previous ones to detect duplicates. Then, parses a
+ *	crafted tree to verify that the parse budget bounds the time spent on such files.
+ */
+BENCHMARK(resources)
+{
+	auto bytes = bench::make_resource_exe(20000);
+	double t = bench::time_it([&bytes]() {
+		auto pe = mana::pe::PE::from_memory(bytes);
+		bench::keep(pe->get_resources()->size());
+	});
+	bench::report("parse 20k resources", t * 1000, "ms");
+
+	// A billion entries, which the parse budget stops after a million.
+	bytes = bench::make_resource_loop_exe(1000);
+	t = bench::time_it([&bytes]() {
+		auto pe = mana::pe::PE::from_memory(bytes);
+		bench::keep(pe->get_resources()->size());
+	}, 1);
+	bench::report("parse a crafted 1000^3 tree", t * 1000, "ms");
+}
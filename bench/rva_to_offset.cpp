@@ -0,0 +1,65 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bench.h"
+#include "synthetic_pe.h"
+#include "manape/pe.h"
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	Parses the exports of a DLL exporting 50.000 functions, preceded by 64 sections.
+ *	Each exported name requires an RVA translation.
+ */
+BENCHMARK(rva_to_offset)
+{
+	const unsigned int EXPORTS = 50000;
+	auto bytes = bench::make_export_dll(EXPORTS, 64);
+
+	double t = bench::time_it([&bytes]() {
+		auto pe = mana::pe::PE::from_memory(bytes);
+		bench::keep(pe->get_exports()->size());
+	});
+	bench::report("parse 50k exports", t * 1000, "ms");
+
+	// Raw lookups, alternating between sections (worst case for the last-hit cache)...
+	auto pe = mana::pe::PE::from_memory(bytes);
+	auto sections = pe->get_sections();
+	std::vector<boost::uint32_t> rvas;
+	for (unsigned int i = 0 ; i < 1000000 ; ++i) {
+		rvas.push_back(sections->at(i % sections->size())->get_virtual_address() + i % 0x100);
+	}
+	t = bench::time_it([&pe, &rvas]() {
+		unsigned int sum = 0;
+		for (auto rva : rvas) {
+			sum += pe->rva_to_offset(rva);
+		}
+		bench::keep(sum);
+	});
+	bench::report("rva_to_offset, scattered", t * 1e9 / rvas.size(), "ns/lookup");
+
+	// ...and sequential ones, like when walking a directory.
+	std::sort(rvas.begin(), rvas.end());
+	t = bench::time_it([&pe, &rvas]() {
+		unsigned int sum = 0;
+		for (auto rva : rvas) {
+			sum += pe->rva_to_offset(rva);
+		}
+		bench::keep(sum);
+	});
+	bench::report("rva_to_offset, sequential", t * 1e9 / rvas.size(), "ns/lookup");
+}
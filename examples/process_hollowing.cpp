@@ -306,27 +306,22 @@ bool do_single_relocation(const ::PROCESS_INFORMATION& pi, PVOID target_address,
  */
 bool apply_relocations(const mana::PE& pe, const ::PROCESS_INFORMATION& pi, boost::uint8_t* base_address)
 {
-	auto relocs = pe.get_relocations();
+	auto relocs = pe.get_relocation_table();
 	boost::int32_t delta = reinterpret_cast<boost::uint32_t>(base_address - pe.get_image_optional_header()->ImageBase);
 
 	// For each relocation, get the remote address to patch and rebase the value located there.
-	for (auto it = relocs->begin() ; it != relocs->end() ; ++it)
+	// Padding entries (IMAGE_REL_BASED_ABSOLUTE) are not part of the table.
+	for (const auto& reloc : *relocs)
 	{
-		for (auto reloc : (*it)->TypesOffsets)
+		if (reloc.Type == IMAGE_REL_BASED_HIGHLOW)
 		{
-			if (reloc >> 12 == IMAGE_REL_BASED_HIGHLOW)
-			{
-				PVOID target_address = base_address + (*it)->PageRVA + (reloc & 0x0FFF);
-				do_single_relocation(pi, target_address, delta);
-			}
-			else if (reloc >> 12 == IMAGE_REL_BASED_ABSOLUTE) { // Padding relocation block.
-				continue;
-			}
-			else
-			{
-				std::cerr << "Warning: unsupported relocation type! (" << *nt::translate_to_flag(reloc >> 12, nt::BASE_RELOCATION_TYPES) 
-						  << ")" << std::endl;
-			}
+			PVOID target_address = base_address + mana::pe::RelocationTable::get_rva(reloc);
+			do_single_relocation(pi, target_address, delta);
+		}
+		else
+		{
+			std::cerr << "Warning: unsupported relocation type! (" << *nt::translate_to_flag(reloc.Type, nt::BASE_RELOCATION_TYPES) 
+					  << ")" << std::endl;
 		}
 	}
 
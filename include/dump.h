@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 
+#include "manape/file_writer.h"
 #include "manape/pe.h"
 #include "manape/utils.h"
 #include "output_formatter.h"
@@ -51,6 +52,18 @@ void dump_hashes(const pe::PE &pe, io::OutputFormatter &formatter);
 void dump_dldt(const pe::PE &pe, io::OutputFormatter &formatter);
 void dump_rich_header(const pe::PE &pe, io::OutputFormatter &formatter);
 
+/**
+ * @brief   Reports whether the parsing of the PE was cut short by its parse_limits.
+ *          Nothing is output if the PE was parsed completely.
+ *
+ *          Directories are parsed on demand: this function should be called after
+ *          everything else has been dumped.
+ *
+ * @param   const pe::PE& pe The PE whose parsing may have been truncated.
+ * @param   io::OutputFormatter& formatter The object which will receive the output.
+ */
+void dump_truncation(const pe::PE &pe, io::OutputFormatter &formatter);
+
 /**
  * @brief   Detects the filetype of a given resource based on magic numbers contained
  *          inside it.
@@ -76,10 +89,14 @@ void dump_rich_header(const pe::PE &pe, io::OutputFormatter &formatter);
  * @param   const pe::PE& pe The PE whose resources we want extracted.
  * @param   const std::string& destination_folder The folder into which the
  *          extracted files should be placed.
+ * @param   pe::BackgroundWriter* writer If set, the files are written on this writer's
+ *          thread and the function returns before they are on the disk. Failures are
+ *          then reported by writer->wait().
  *
  * @return  Whether the extraction was successful.
  */
-bool extract_resources(const pe::PE &pe, const std::string &destination_folder);
+bool extract_resources(const pe::PE &pe, const std::string &destination_folder,
+                       pe::BackgroundWriter *writer = nullptr);
 
 /**
  *	@brief	Extracts the certificates used for the Authenticode signature of the PE.
@@ -103,6 +103,20 @@ DECLSPEC_MANACOMMONS const_shared_strings hash_file(const std::vector<pHash> &di
 DECLSPEC_MANACOMMONS const_shared_strings hash_bytes(const std::vector<pHash> &digests,
                                               const std::vector<boost::uint8_t> &bytes);
 
+/**
+ *	@brief	Computes the hashes of a buffer which isn't stored in a vector, such as a
+ *			view on a memory-mapped file.
+ *
+ *	@param	const std::vector<pDigest>& digests A list of digests to use.
+ *	@param	const boost::uint8_t* data The buffer to hash.
+ *	@param	size_t size The size of the buffer.
+ *
+ *	@return	A shared vector containing all the computed hashes, in the same order as the
+ *input digests. If an error occurs for any digest, the return value's size is set to 0.
+ */
+DECLSPEC_MANACOMMONS const_shared_strings hash_bytes(const std::vector<pHash> &digests,
+                                              const boost::uint8_t *data, size_t size);
+
 /**
  *	@brief	Computes the hash of a PE's imports.
  *	Per http://www.mandiant.com/blog/tracking-malware-import-hashing/
@@ -0,0 +1,139 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "manape/export.h"
+
+#ifndef __MANAPE_ARENA__
+#define __MANAPE_ARENA__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	A memory pool from which the structures of a PE are allocated.
+ *
+ *	Parsing a PE creates a lot of small objects (imports, exports, resources, ...),
+ *	each of which would otherwise be a separate heap allocation with its own reference
+ *	count. The arena hands out memory from large chunks instead. Objects are never
+ *	freed individually: they are all destroyed, and the chunks released, at the same
+ *	time as the arena.
+ *
+ *	Use make_in_arena() to create objects. The pointers it returns share the reference
+ *	count of the arena itself, which means that structures obtained from a PE remain
+ *	valid after the PE object has been destroyed. As a consequence, objects stored in
+ *	the arena must never hold such pointers themselves: this would create a cycle and
+ *	the arena would never be released.
+ *
+ *	The flip side is that memory is only given back as a whole: holding on to a single
+ *	structure returned by the PE's getters (one pResource, one pexported_function...)
+ *	keeps every structure of that PE in memory. Objects which callers are expected to
+ *	keep around independently, or which are released before the PE, should be
+ *	allocated normally instead (see ImportedLibrary).
+ *
+ *	Allocations are thread-safe, since directories can be parsed concurrently.
+ */
+class Arena {
+  public:
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    /**
+     *	@param	bool pooled Whether make_in_arena() places objects in this arena. When it
+     *			is false, each object is allocated with boost::make_shared instead, which
+     *			is only useful to measure what the arena saves.
+     */
+    DECLSPEC_MANAPE explicit Arena(bool pooled = true);
+    DECLSPEC_MANAPE ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     *	@brief	Reserves memory in the arena.
+     *
+     *	@param	size_t size The number of bytes needed.
+     *	@param	size_t alignment The alignment of the returned address. It must be a
+     *			power of two, no bigger than alignof(std::max_align_t).
+     *
+     *	@return	A pointer to the memory, which remains valid until the arena is
+     *			destroyed.
+     */
+    DECLSPEC_MANAPE void *allocate(size_t size, size_t alignment);
+
+    /**
+     *	@brief	Registers a function which destroys an object located in the arena.
+     *			These functions are called in reverse order when the arena is destroyed.
+     */
+    DECLSPEC_MANAPE void on_destruction(void *object, void (*destroy)(void *));
+
+    /**
+     *	@brief	Returns the number of chunks requested from the system so far.
+     */
+    DECLSPEC_MANAPE size_t get_chunk_count() const;
+
+    /**
+     *	@brief	Tells whether make_in_arena() places objects in this arena, or allocates
+     *			them separately.
+     */
+    DECLSPEC_MANAPE bool is_pooled() const { return _pooled; }
+
+  private:
+    const bool _pooled;
+    mutable std::mutex _lock;
+    std::vector<std::unique_ptr<boost::uint8_t[]>> _chunks;
+    std::vector<std::pair<void *, void (*)(void *)>> _destructors;
+    boost::uint8_t *_current;
+    size_t _remaining;
+};
+typedef boost::shared_ptr<Arena> pArena;
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Creates an object inside an arena.
+ *
+ *	@param	const pArena& arena The arena in which the object is created.
+ *	@param	Args&&... args The arguments passed to the constructor of the object.
+ *
+ *	@return	A pointer to the object, which keeps the whole arena alive.
+ */
+template <class T, class... Args>
+boost::shared_ptr<T> make_in_arena(const pArena &arena, Args &&...args) {
+    if (!arena->is_pooled()) {
+        return boost::make_shared<T>(std::forward<Args>(args)...);
+    }
+    void *memory = arena->allocate(sizeof(T), alignof(T));
+    T *object = new (memory) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+        arena->on_destruction(object, [](void *p) { static_cast<T *>(p)->~T(); });
+    }
+    // Aliasing constructor: no reference count is allocated for the object.
+    return boost::shared_ptr<T>(arena, object);
+}
+
+} // namespace mana::pe
+
+#endif // __MANAPE_ARENA__
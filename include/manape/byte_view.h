@@ -0,0 +1,115 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/make_shared.hpp>
+
+#include "manape/export.h"
+#include "manape/file_buffer.h"
+#include "types.h"
+
+#ifndef __MANAPE_BYTE_VIEW__
+#define __MANAPE_BYTE_VIEW__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	A read-only slice of the file being analyzed.
+ *
+ *	Views point directly into the FileBuffer and hold a reference to it, so that the
+ *	bytes remain valid for as long as the view exists, even if the PE object has been
+ *	destroyed. Creating or copying a view never copies the underlying data.
+ */
+class ByteView {
+  public:
+    DECLSPEC_MANAPE ByteView() : _data(nullptr), _size(0) {}
+
+    /**
+     *	@brief	Creates a view over a region of a file.
+     *
+     *	@param	pFileBuffer file The file to look into.
+     *	@param	boost::uint64_t offset The offset at which the view starts.
+     *	@param	boost::uint64_t size The size of the view. It is truncated if the region
+     *			goes past the end of the file.
+     */
+    DECLSPEC_MANAPE ByteView(pFileBuffer file, boost::uint64_t offset,
+                             boost::uint64_t size)
+        : _data(nullptr), _size(0) {
+        if (file == nullptr || offset >= file->size()) {
+            return;
+        }
+        _data = file->data() + offset;
+        _size = static_cast<size_t>(std::min(size, file->size() - offset));
+        _file = std::move(file);
+    }
+
+    DECLSPEC_MANAPE const boost::uint8_t *data() const { return _data; }
+    DECLSPEC_MANAPE size_t size() const { return _size; }
+    DECLSPEC_MANAPE bool empty() const { return _size == 0; }
+
+    DECLSPEC_MANAPE const boost::uint8_t *begin() const { return _data; }
+    DECLSPEC_MANAPE const boost::uint8_t *end() const { return _data + _size; }
+
+    DECLSPEC_MANAPE boost::uint8_t operator[](size_t index) const { return _data[index]; }
+
+    /**
+     *	@brief	Returns the file the view points into (which may be NULL for empty views),
+     *			and the offset of the view in that file.
+     */
+    DECLSPEC_MANAPE pFileBuffer get_file() const { return _file; }
+    DECLSPEC_MANAPE boost::uint64_t get_offset() const {
+        return _file == nullptr ? 0 : static_cast<boost::uint64_t>(_data - _file->data());
+    }
+
+    /**
+     *	@brief	Returns a view over a part of this view.
+     *
+     *	@param	size_t offset The offset of the sub-view, relative to the start of this one.
+     *	@param	size_t size The size of the sub-view. It is truncated if necessary.
+     */
+    DECLSPEC_MANAPE ByteView subview(size_t offset, size_t size) const {
+        ByteView res;
+        if (offset >= _size) {
+            return res;
+        }
+        res._file = _file;
+        res._data = _data + offset;
+        res._size = std::min(size, _size - offset);
+        return res;
+    }
+
+    /**
+     *	@brief	Copies the bytes of the view into a new vector.
+     *
+     *	This is only needed when interacting with APIs which require a std::vector.
+     */
+    DECLSPEC_MANAPE shared_bytes to_vector() const {
+        return boost::make_shared<std::vector<boost::uint8_t>>(begin(), end());
+    }
+
+  private:
+    pFileBuffer _file;
+    const boost::uint8_t *_data;
+    size_t _size;
+};
+
+} // namespace mana::pe
+
+#endif // __MANAPE_BYTE_VIEW__
@@ -0,0 +1,171 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/api_config.hpp>
+
+#include "manape/export.h"
+#include "types.h"
+
+#ifndef __MANAPE_FILE_BUFFER__
+#define __MANAPE_FILE_BUFFER__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	Read-only access to the bytes of the file being analyzed.
+ *
+ *	Whenever possible, the whole file is memory-mapped so that the parsers can access
+ *	any structure without issuing a system call. Files which cannot be mapped (i.e.
+ *	empty or special files) are loaded in memory instead, which provides the same
+ *	interface. A FileBuffer can also be built over bytes which are already in memory,
+ *	in which case no file is involved at all.
+ *
+ *	All the methods of this class are const and do not maintain a file cursor, so a
+ *	single FileBuffer can be shared between threads.
+ */
+class FileBuffer {
+  public:
+    /**
+     *	@brief	Opens a file and maps it in memory.
+     *
+     *	@param	const std::string& path The path to the file to open.
+     *	@param	bool random_access Hints the system that only a few scattered pages will
+     *			be accessed, which disables read-ahead on the mapping.
+     *
+     *	@return	A shared FileBuffer, or nullptr if the file could not be opened.
+     */
+    DECLSPEC_MANAPE static boost::shared_ptr<FileBuffer>
+    open(const std::string &path, bool random_access = false);
+
+    /**
+     *	@brief	Wraps a buffer which is already in memory.
+     *
+     *	@param	shared_bytes bytes The contents of the file. The FileBuffer keeps a
+     *			reference to it, so no copy is made.
+     *
+     *	@return	A shared FileBuffer, or nullptr if bytes is NULL.
+     */
+    DECLSPEC_MANAPE static boost::shared_ptr<FileBuffer> from_memory(shared_bytes bytes);
+
+    /**
+     *	@brief	Wraps a buffer owned by the caller.
+     *
+     *	/!\ The memory is borrowed: it must remain valid and unmodified for as long as
+     *	the FileBuffer (and any object created from it) exists!
+     *
+     *	@param	const boost::uint8_t* data The contents of the file.
+     *	@param	boost::uint64_t size The size of the buffer.
+     *
+     *	@return	A shared FileBuffer, or nullptr if data is NULL.
+     */
+    DECLSPEC_MANAPE static boost::shared_ptr<FileBuffer>
+    from_memory(const boost::uint8_t *data, boost::uint64_t size);
+
+    DECLSPEC_MANAPE virtual ~FileBuffer();
+
+    FileBuffer(const FileBuffer &) = delete;
+    FileBuffer &operator=(const FileBuffer &) = delete;
+
+    /**
+     *	@brief	Returns a pointer to the first byte of the file.
+     *
+     *	The pointer remains valid for as long as this object exists. It may be NULL if
+     *	the file is empty.
+     */
+    DECLSPEC_MANAPE const boost::uint8_t *data() const { return _data; }
+
+    DECLSPEC_MANAPE boost::uint64_t size() const { return _size; }
+
+    /**
+     *	@brief	Tells whether the file's contents are backed by a memory mapping (as
+     *			opposed to a copy on the heap).
+     */
+    DECLSPEC_MANAPE bool is_mapped() const { return _mapped_address != nullptr; }
+
+    /**
+     *	@brief	Returns the path of the file the bytes were read from, or an empty string
+     *			if the FileBuffer was created from memory.
+     */
+    DECLSPEC_MANAPE const std::string &get_path() const { return _path; }
+
+    /**
+     *	@brief	Returns a descriptor of the mapped file, which lets the system copy parts
+     *			of it without going through the mapping.
+     *
+     *	It refers to the file which was mapped, even if another file has since been
+     *	moved to the same path. The descriptor belongs to this object and must not be
+     *	closed by the caller.
+     *
+     *	@return	The descriptor, or -1 if the FileBuffer is not backed by a mapping, or
+     *			if the file has been modified since it was mapped.
+     */
+    DECLSPEC_MANAPE int get_descriptor() const;
+
+    /**
+     *	@brief	Copies bytes from the file into a caller-supplied buffer.
+     *
+     *	@param	boost::uint64_t offset The offset in the file where the read starts.
+     *	@param	void* destination The buffer which will receive the data.
+     *	@param	size_t size The number of bytes to read.
+     *
+     *	@return	The number of bytes actually copied, which is smaller than size if the
+     *			end of the file was reached.
+     */
+    DECLSPEC_MANAPE size_t read(boost::uint64_t offset, void *destination,
+                                size_t size) const {
+        if (offset >= _size) {
+            return 0;
+        }
+        if (size > _size - offset) {
+            size = static_cast<size_t>(_size - offset);
+        }
+        if (size) {
+            memcpy(destination, _data + offset, size);
+        }
+        return size;
+    }
+
+  private:
+    FileBuffer();
+
+    const boost::uint8_t *_data;
+    boost::uint64_t _size;
+
+    // Set when the file is memory-mapped.
+    void *_mapped_address;
+    // The descriptor of the mapped file (POSIX only), and its modification time when it
+    // was mapped, in nanoseconds.
+    int _fd;
+    boost::int64_t _mtime;
+    // Fallback storage, used when the file could not be mapped.
+    std::vector<boost::uint8_t> _contents;
+    // Set when the FileBuffer was created from a caller-supplied vector.
+    shared_bytes _owner;
+    // Set when the FileBuffer was created from a file on the disk.
+    std::string _path;
+};
+typedef boost::shared_ptr<const FileBuffer> pFileBuffer;
+
+} // namespace mana::pe
+
+#endif // __MANAPE_FILE_BUFFER__
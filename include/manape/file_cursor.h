@@ -0,0 +1,261 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <type_traits>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include "manape/byte_view.h"
+#include "manape/export.h"
+#include "manape/file_buffer.h"
+
+#ifndef __MANAPE_FILE_CURSOR__
+#define __MANAPE_FILE_CURSOR__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	A bounded read position inside a FileBuffer.
+ *
+ *	This object replaces the FILE* cursor the parsers used to share: it offers the
+ *	same seek / tell / read primitives, but reading only amounts to a memory copy.
+ *	Cursors are cheap to create, and each parsing function uses its own so that the
+ *	PE object never has to maintain a shared file position.
+ *
+ *	A cursor can be restricted to a range of the file (see subrange()), in which case
+ *	no read will ever go past the end of that range. Offsets are always expressed
+ *	relatively to the start of the file.
+ */
+class FileCursor {
+  public:
+    DECLSPEC_MANAPE explicit FileCursor(pFileBuffer file, boost::uint64_t offset = 0)
+        : _file(std::move(file)), _offset(offset), _begin(0),
+          _end(_file == nullptr ? 0 : _file->size()) {}
+
+    /**
+     *	@brief	Moves the cursor to an absolute offset.
+     *
+     *	@return	Whether the offset is located inside the cursor's range.
+     */
+    DECLSPEC_MANAPE bool seek(boost::uint64_t offset) {
+        if (_file == nullptr || offset < _begin || offset > _end) {
+            return false;
+        }
+        _offset = offset;
+        return true;
+    }
+
+    /**
+     *	@brief	Moves the cursor relatively to its current position.
+     *
+     *	@return	Whether the new position is located inside the file.
+     */
+    DECLSPEC_MANAPE bool skip(boost::int64_t delta) {
+        if (delta < 0 && static_cast<boost::uint64_t>(-delta) > _offset) {
+            return false;
+        }
+        return seek(_offset + delta);
+    }
+
+    DECLSPEC_MANAPE boost::uint64_t tell() const { return _offset; }
+
+    /**
+     *	@brief	Returns the number of bytes which can still be read from the cursor.
+     */
+    DECLSPEC_MANAPE boost::uint64_t remaining() const {
+        return _offset < _end ? _end - _offset : 0;
+    }
+
+    /**
+     *	@brief	Returns a pointer to the byte located at the current position, or NULL
+     *			if there is nothing left to read.
+     *
+     *	The pointer is valid for remaining() bytes, and for as long as the underlying
+     *	FileBuffer exists.
+     */
+    DECLSPEC_MANAPE const boost::uint8_t *data() const {
+        return remaining() ? _file->data() + _offset : nullptr;
+    }
+
+    /**
+     *	@brief	Copies bytes from the current position and advances the cursor.
+     *
+     *	@param	void* destination The buffer which will receive the data.
+     *	@param	size_t size The number of bytes to read.
+     *
+     *	@return	The number of bytes read, which may be smaller than size if the end of
+     *			the cursor's range was reached.
+     */
+    DECLSPEC_MANAPE size_t read(void *destination, size_t size) {
+        if (size > remaining()) {
+            size = static_cast<size_t>(remaining());
+        }
+        if (size) {
+            memcpy(destination, _file->data() + _offset, size);
+            _offset += size;
+        }
+        return size;
+    }
+
+    /**
+     *	@brief	Reads a little-endian integer and advances the cursor.
+     *
+     *	@param	T& out Where the value will be stored. It is left untouched if there are
+     *			not enough bytes left.
+     *
+     *	@return	Whether the value could be read.
+     */
+    template <class T> bool read_le(T &out) {
+        static_assert(std::is_integral<T>::value, "read_le only reads integers.");
+        if (remaining() < sizeof(T)) {
+            return false;
+        }
+        T value;
+        memcpy(&value, _file->data() + _offset, sizeof(T));
+        out = boost::endian::little_to_native(value);
+        _offset += sizeof(T);
+        return true;
+    }
+
+    /**
+     *	@brief	Reads a little-endian integer whose size is only known at runtime (i.e.
+     *			fields which are 32 bits wide in PE32 and 64 bits wide in PE32+).
+     *
+     *	@param	T& out Where the value will be stored. It is zero-extended.
+     *	@param	unsigned int size The number of bytes to read, which cannot be bigger
+     *			than sizeof(T).
+     *
+     *	@return	Whether the value could be read.
+     */
+    template <class T> bool read_le(T &out, unsigned int size) {
+        static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                      "read_le only reads unsigned integers.");
+        if (size > sizeof(T) || remaining() < size) {
+            return false;
+        }
+        const boost::uint8_t *p = _file->data() + _offset;
+        T value = 0;
+        for (unsigned int i = size; i > 0; --i) {
+            value = static_cast<T>((value << 8) | p[i - 1]);
+        }
+        out = value;
+        _offset += size;
+        return true;
+    }
+
+    /**
+     *	@brief	Reads an array of little-endian integers in a single operation.
+     *
+     *	@param	std::vector<T>& out The vector which will receive the values.
+     *	@param	size_t count The number of integers to read.
+     *
+     *	@return	Whether all the values could be read. Nothing is allocated if the
+     *			cursor's range cannot contain count values, which makes this function
+     *			safe to call with untrusted sizes.
+     */
+    template <class T> bool read_array(std::vector<T> &out, size_t count) {
+        static_assert(std::is_integral<T>::value, "read_array only reads integers.");
+        if (count > remaining() / sizeof(T)) {
+            return false;
+        }
+        out.resize(count);
+        if (count) {
+            memcpy(&out[0], _file->data() + _offset, count * sizeof(T));
+            _offset += count * sizeof(T);
+        }
+        if (boost::endian::order::native != boost::endian::order::little) {
+            for (auto &value : out) {
+                boost::endian::little_to_native_inplace(value);
+            }
+        }
+        return true;
+    }
+
+    /**
+     *	@brief	Returns a view over the next bytes of the cursor and advances it. No
+     *			data is copied.
+     *
+     *	@param	size_t size The size of the view. It is truncated if the end of the
+     *			cursor's range is reached.
+     */
+    DECLSPEC_MANAPE ByteView view(size_t size) {
+        if (size > remaining()) {
+            size = static_cast<size_t>(remaining());
+        }
+        ByteView res(_file, _offset, size);
+        _offset += size;
+        return res;
+    }
+
+    /**
+     *	@brief	Creates a new cursor located at another offset, with the same range.
+     *
+     *	This is the way to follow a pointer to another structure without losing the
+     *	current position.
+     *
+     *	@param	boost::uint64_t offset The absolute offset of the new cursor.
+     *
+     *	@return	A new cursor. If the offset is outside of the range, the cursor is empty
+     *			and all reads will fail.
+     */
+    DECLSPEC_MANAPE FileCursor at(boost::uint64_t offset) const {
+        FileCursor res(*this);
+        if (!res.seek(offset)) {
+            res._begin = res._end = res._offset = _end;
+        }
+        return res;
+    }
+
+    /**
+     *	@brief	Creates a new cursor which cannot read outside of a part of the file.
+     *
+     *	@param	boost::uint64_t offset The absolute offset where the range starts. The
+     *			new cursor is positioned there.
+     *	@param	boost::uint64_t size The size of the range. It is truncated to fit
+     *			inside the current cursor's range.
+     *
+     *	@return	A new cursor, which is empty if the offset is outside of the current
+     *			range.
+     */
+    DECLSPEC_MANAPE FileCursor subrange(boost::uint64_t offset,
+                                        boost::uint64_t size) const {
+        FileCursor res = at(offset);
+        if (res._end - res._offset > size) {
+            res._end = res._offset + size;
+        }
+        res._begin = res._offset;
+        return res;
+    }
+
+    DECLSPEC_MANAPE bool eof() const { return remaining() == 0; }
+
+    DECLSPEC_MANAPE const pFileBuffer &get_file() const { return _file; }
+
+  private:
+    pFileBuffer _file;
+    boost::uint64_t _offset;
+
+    // The part of the file this cursor is allowed to read: [_begin, _end).
+    boost::uint64_t _begin;
+    boost::uint64_t _end;
+};
+
+} // namespace mana::pe
+
+#endif // __MANAPE_FILE_CURSOR__
@@ -0,0 +1,114 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "manape/byte_view.h"
+#include "manape/export.h"
+
+#ifndef __MANAPE_FILE_WRITER__
+#define __MANAPE_FILE_WRITER__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	Writes parts of the analyzed files (and other bytes) to a new file.
+ *
+ *	Views pointing into a file on the disk are copied by the kernel (copy_file_range,
+ *	or sendfile if the filesystems don't allow it) so that their bytes don't have to go
+ *	through the process. Small views, views over memory and unsupported systems fall
+ *	back to regular writes from the mapped file.
+ *
+ *	@param	const boost::filesystem::path& destination The file to create. It is
+ *			overwritten if it exists, unless append is set.
+ *	@param	const std::vector<ByteView>& views The bytes to write, in order.
+ *	@param	bool append Whether the bytes are added at the end of an existing file.
+ *
+ *	@return	Whether all the bytes were written.
+ */
+DECLSPEC_MANAPE bool write_to_file(const boost::filesystem::path &destination,
+                                   const std::vector<ByteView> &views,
+                                   bool append = false);
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Runs file writing jobs on a dedicated thread, so that the analysis can go on
+ *			while extracted files are written to the disk.
+ *
+ *	Jobs are executed in the order in which they were submitted. The queue is bounded:
+ *	submit() blocks while too many jobs are pending, which limits the amount of memory
+ *	(and the number of mapped files) held by the queue.
+ */
+class BackgroundWriter {
+  public:
+    typedef std::function<bool()> job;
+
+    /**
+     *	@param	size_t max_pending The number of jobs which can wait in the queue before
+     *			submit() starts blocking.
+     */
+    DECLSPEC_MANAPE explicit BackgroundWriter(size_t max_pending = 64);
+
+    /**
+     *	@brief	Waits for the pending jobs before stopping the thread.
+     */
+    DECLSPEC_MANAPE ~BackgroundWriter();
+
+    BackgroundWriter(const BackgroundWriter &) = delete;
+    BackgroundWriter &operator=(const BackgroundWriter &) = delete;
+
+    /**
+     *	@brief	Queues a job. Blocks if the queue is full.
+     *
+     *	@param	job j The function to run. It returns false if the write failed.
+     */
+    DECLSPEC_MANAPE void submit(job j);
+
+    /**
+     *	@brief	Waits until all the submitted jobs have been executed.
+     *
+     *	@return	Whether all the jobs executed since the last call to wait() succeeded.
+     */
+    DECLSPEC_MANAPE bool wait();
+
+  private:
+    void _run();
+
+    std::mutex _mutex;
+    std::condition_variable _job_available;
+    std::condition_variable _slot_available;
+    std::condition_variable _idle;
+    std::deque<job> _jobs;
+    size_t _max_pending;
+    bool _busy;     // A job is being executed.
+    bool _stopping; // Set by the destructor.
+    bool _success;  // No job failed since the last call to wait().
+    std::thread _thread;
+};
+
+} // namespace mana::pe
+
+#endif // __MANAPE_FILE_WRITER__
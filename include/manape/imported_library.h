@@ -22,6 +22,7 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 #include <boost/shared_ptr.hpp>
 
 #include "manape/export.h"
+#include "manape/ordinals.h"
 #include "manape/pe_structs.h"
 #include "types.h"
 
@@ -74,6 +75,17 @@ class ImportedLibrary {
         return _image_import_descriptor;
     }
 
+    /**
+     *	@brief	Returns the name of a function imported from this library.
+     *
+     *	@param	const import_lookup_table& import The imported function.
+     *
+     *	@return	The function's name. If it is imported by ordinal, the ordinal is
+     *			translated if it is known, or returned as "#[ordinal]" otherwise.
+     */
+    DECLSPEC_MANAPE std::string
+    get_function_name(const import_lookup_table &import) const;
+
     void add_import(pimport_lookup_table import) {
         _imported_functions->push_back(import);
     }
@@ -84,6 +96,7 @@ class ImportedLibrary {
     LOAD_TYPE _load_type;
     std::string _library_name;
     pImports _imported_functions;
+    const nt::ordinal_table *_ordinals; // Resolved once from the library's name.
 };
 
 typedef boost::shared_ptr<ImportedLibrary> pImportedLibrary;
@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License
 along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cstddef>
 #include <map>
 #include <sstream>
 #include <string>
@@ -54,11 +55,89 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 #define WIN_CERT_TYPE_PKCS_SIGNED_DATA 2
 #endif
 
+// Values the parser compares against directly, so that it doesn't have to look them up
+// by name in the tables below. They are guarded as WinNT.h may already define them.
+#ifndef IMAGE_NT_OPTIONAL_HDR32_MAGIC
+#define IMAGE_NT_OPTIONAL_HDR32_MAGIC 0x10b
+#endif
+#ifndef IMAGE_NT_OPTIONAL_HDR64_MAGIC
+#define IMAGE_NT_OPTIONAL_HDR64_MAGIC 0x20b
+#endif
+#ifndef IMAGE_DEBUG_TYPE_CODEVIEW
+#define IMAGE_DEBUG_TYPE_CODEVIEW 2
+#endif
+#ifndef IMAGE_DEBUG_TYPE_MISC
+#define IMAGE_DEBUG_TYPE_MISC 4
+#endif
+#ifndef IMAGE_SCN_MEM_EXECUTE
+#define IMAGE_SCN_MEM_EXECUTE 0x20000000
+#endif
+#ifndef IMAGE_SCN_MEM_WRITE
+#define IMAGE_SCN_MEM_WRITE 0x80000000
+#endif
+#ifndef VFT_DRV
+#define VFT_DRV 3
+#endif
+#ifndef VFT_FONT
+#define VFT_FONT 4
+#endif
+
 namespace mana::nt {
 
-typedef std::map<std::string, unsigned int> flag_dict;
+/**
+ *	@brief	An entry of a flag translation table.
+ */
+struct flag
+{
+    const char* name;
+    unsigned int value;
+};
 
-// Exported flag translation maps. Definition in nt_values.cpp.
+/**
+ *	@brief	A read-only flag translation table.
+ *
+ *	The tables are sorted at compile time (see MAKE_FLAG_DICT in nt_values.cpp), so they
+ *	require no initialization at startup. Iterating over one enumerates its flags in
+ *	alphabetical order, and a second copy of the entries sorted by value allows
+ *	translating values back to names with a binary search.
+ */
+class DECLSPEC_MANAPE flag_dict
+{
+public:
+    constexpr flag_dict(const flag* by_name, const flag* by_value, size_t size)
+        : _by_name(by_name), _by_value(by_value), _size(size)
+    {}
+
+    const flag* begin() const { return _by_name; }
+    const flag* end() const { return _by_name + _size; }
+    size_t size() const { return _size; }
+
+    /**
+     *	@brief	Returns the value associated to a flag name.
+     *
+     *	@param	const std::string& name The name of the flag.
+     *
+     *	@return	The value of the flag. std::out_of_range is thrown if it doesn't exist.
+     */
+    unsigned int at(const std::string& name) const;
+
+    /**
+     *	@brief	Looks up the flag corresponding to a given value.
+     *
+     *	@param	unsigned int value The value to translate.
+     *
+     *	@return	The name of the flag, or nullptr if no flag has this value. If several
+     *			flags share it, the first one in alphabetical order is returned.
+     */
+    const char* find(unsigned int value) const;
+
+private:
+    const flag* _by_name;
+    const flag* _by_value;
+    size_t _size;
+};
+
+// Exported flag translation tables. Definition in nt_values.cpp.
 extern const DECLSPEC_MANAPE flag_dict PE_CHARACTERISTICS;
 extern const DECLSPEC_MANAPE flag_dict MACHINE_TYPES;
 extern const DECLSPEC_MANAPE flag_dict IMAGE_OPTIONAL_HEADER_MAGIC;
@@ -82,7 +161,7 @@ extern const DECLSPEC_MANAPE flag_dict HEAP_FLAGS;
 extern const DECLSPEC_MANAPE flag_dict GUARD_FLAGS;
 
 // RICH header tables
-extern const DECLSPEC_MANAPE std::map<int, std::string> COMP_ID_TYPE;
+extern const DECLSPEC_MANAPE flag_dict COMP_ID_TYPE;
 extern const DECLSPEC_MANAPE flag_dict COMP_ID_PRODID;
 
 /**
@@ -15,9 +15,10 @@ You should have received a copy of the GNU General Public License
 along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <map>
-#include <sstream>
+#include <algorithm>
+#include <cstddef>
 #include <string>
+#include <utility>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/assign.hpp>
@@ -35,18 +36,63 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 namespace mana::nt {
 
 /**
- *  @brief  A map which contains a list of function names corresponding to known DLL
- * ordinals.
+ *  @brief  The name of a function exported by ordinal.
+ */
+struct ordinal_name {
+    boost::uint16_t ordinal;
+    const char *name;
+};
+
+/**
+ *  @brief  The list of known ordinals of a DLL.
+ *
+ *  Tables are static arrays sorted by ordinal (see ordinals.cpp), which are searched
+ *  with a binary search.
+ */
+class DECLSPEC_MANAPE ordinal_table {
+  public:
+    template <size_t N>
+    constexpr ordinal_table(const ordinal_name (&entries)[N])
+        : _entries(entries), _size(N) {}
+
+    /**
+     *  @brief  Looks up the function corresponding to an ordinal.
+     *
+     *  @param  ordinal The ordinal to translate.
+     *
+     *  @return The name of the function, or nullptr if the ordinal is unknown.
+     */
+    const char *find(boost::uint16_t ordinal) const;
+
+  private:
+    const ordinal_name *_entries;
+    size_t _size;
+};
+
+/**
+ *  @brief  Finds the table of known ordinals for a DLL.
  *
- * The map is in the form: { "first.dll":   { 1: "function 1", 2: "function 2", ... },
- *                           "second.dll":  { 3: "function 3", ... } }
+ *  @param  dll The name of the DLL. The comparison is case insensitive.
  *
- * Keys are lowercase DLL names. To generate a map, run manalyze with the -d export option
- * on target DLL and apply the following regular expression to the result: Replace:
- * ([A-Za-z0-9_\-]+):\r\n\s+Ordinal:\s*(\d+) With:        \($2,\t\t"$1"\)
+ *  @return The table of ordinals, or nullptr if the DLL's ordinals are unknown.
+ */
+DECLSPEC_MANAPE const ordinal_table *find_ordinal_table(const std::string &dll);
+
+/**
+ *  @brief  Translates an ordinal into a function name, if possible.
+ *
+ *  This overload should be preferred when translating several ordinals of the same DLL,
+ *  as the table only has to be looked up once.
+ *
+ *  @param  ordinal The ordinal to translate.
+ *  @param  table The ordinals of the DLL, as returned by find_ordinal_table. May be
+ *          nullptr.
+ *
+ *  @return The name of the function corresponding to the ordinal, or a string containing
+ * "#[ordinal]" if it could not be translated.
  */
-extern DECLSPEC_MANAPE const std::map<std::string, std::map<boost::uint16_t, std::string>>
-    ORDINAL_MAP;
+DECLSPEC_MANAPE std::string translate_ordinal(boost::uint16_t ordinal,
+                                              const ordinal_table *table);
 
 /**
  *  @brief  Translates an ordinal into a function name, if possible.
@@ -0,0 +1,153 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <boost/cstdint.hpp>
+
+#include "manape/export.h"
+
+#ifndef __MANAPE_PARSE_BUDGET__
+#define __MANAPE_PARSE_BUDGET__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	Limits on the work performed while parsing a single PE.
+ *
+ *	Malformed files can declare millions of entries in their directories, or make the
+ *	parser read the same structures over and over. These limits make sure that a
+ *	hostile file cannot keep the parser busy for long. A value of 0 disables the
+ *	corresponding limit.
+ */
+typedef struct parse_limits_t {
+    // The number of bytes the parser may read from the file, all directories combined.
+    boost::uint64_t max_bytes = 256 * 1024 * 1024;
+    // The number of entries (symbols, imports, resources...) read in a single directory.
+    boost::uint32_t max_entries = 1'000'000;
+    // How long parsing may take, in milliseconds. Directories are parsed on demand, so
+    // only the time spent inside the parsers is counted.
+    boost::uint32_t max_duration = 0;
+    // Whether the parsed structures are allocated from the PE's arena. Disabling it is
+    // only useful to measure what the arena saves (see bench/allocations.cpp).
+    bool use_arena = true;
+} parse_limits;
+
+/**
+ *	@brief	Describes how the parsing of a PE was cut short by its parse_limits.
+ */
+typedef struct truncation_t {
+    enum reason { NONE = 0, BYTES = 1, ENTRIES = 2, DEADLINE = 4 };
+
+    unsigned int reasons = NONE;       // A combination of the reason flags.
+    std::set<std::string> directories; // The directories which are incomplete.
+} truncation;
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Keeps track of the resources consumed while parsing a PE, and decides
+ *			when the parser should give up.
+ *
+ *	Parsers call consume() or allowed_entries() before reading, and stop (keeping what
+ *	they read so far) when the budget is exhausted. Each truncation is recorded so that
+ *	it can be reported by PE::get_truncation(). Parsers must also hold a Timer while
+ *	they run, so that the deadline accounts for their work.
+ *
+ *	This class is thread-safe, since directories can be parsed concurrently.
+ */
+class ParseBudget {
+  public:
+    /**
+     *	@brief	Measures the time spent parsing, from its creation to its destruction.
+     *			Nested and concurrent timers are counted only once.
+     */
+    class Timer {
+      public:
+        DECLSPEC_MANAPE explicit Timer(ParseBudget &budget);
+        DECLSPEC_MANAPE ~Timer();
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+      private:
+        ParseBudget &_budget;
+    };
+
+    DECLSPEC_MANAPE explicit ParseBudget(const parse_limits &limits = parse_limits());
+    ParseBudget(const ParseBudget &) = delete;
+    ParseBudget &operator=(const ParseBudget &) = delete;
+
+    /**
+     *	@brief	Accounts for bytes read from the file, and checks the deadline.
+     *
+     *	@param	boost::uint64_t bytes The number of bytes about to be read.
+     *	@param	const char* directory The directory being parsed, for the report.
+     *
+     *	@return	Whether the read may proceed. Once the byte budget or the deadline has
+     *			been exceeded, this function always returns false.
+     */
+    DECLSPEC_MANAPE bool consume(boost::uint64_t bytes, const char *directory);
+
+    /**
+     *	@brief	Caps the number of entries read in a directory.
+     *
+     *	@param	boost::uint64_t count The number of entries the directory claims to have.
+     *	@param	const char* directory The directory being parsed, for the report.
+     *
+     *	@return	The number of entries which may be read.
+     */
+    DECLSPEC_MANAPE boost::uint64_t allowed_entries(boost::uint64_t count,
+                                                    const char *directory);
+
+    /**
+     *	@brief	Tells whether a directory may contain count entries. Used by parsers
+     *			which don't know the number of entries in advance.
+     */
+    DECLSPEC_MANAPE bool check_entries(boost::uint64_t count, const char *directory) {
+        return allowed_entries(count, directory) == count;
+    }
+
+    DECLSPEC_MANAPE truncation get_truncation() const;
+    DECLSPEC_MANAPE bool is_truncated() const { return _reasons != truncation::NONE; }
+    DECLSPEC_MANAPE const parse_limits &get_limits() const { return _limits; }
+
+  private:
+    void _truncate(truncation::reason reason, const char *directory);
+
+    /**
+     *	@brief	Returns the time spent inside the parsers so far.
+     */
+    std::chrono::steady_clock::duration _elapsed() const;
+
+    const parse_limits _limits;
+    // Time measured by the timers which have stopped, and start of the current period.
+    std::chrono::steady_clock::duration _parse_time;
+    std::chrono::steady_clock::time_point _start;
+    unsigned int _running_timers;
+    std::atomic<boost::uint64_t> _bytes;
+    std::atomic<unsigned int> _reasons;
+    mutable std::mutex _lock;
+    std::set<std::string> _directories;
+};
+
+} // namespace mana::pe
+
+#endif // __MANAPE_PARSE_BUDGET__
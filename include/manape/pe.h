@@ -18,11 +18,13 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <exception>
 #include <iostream>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/bind/bind.hpp>
@@ -34,10 +36,16 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 #include <boost/system/api_config.hpp>
 
 #include "manacommons/color.h"
+#include "manape/arena.h" // Memory pool backing the parsed structures
+#include "manape/byte_view.h"
+#include "manape/file_buffer.h" // Memory-mapped contents of the file
+#include "manape/file_cursor.h"
 #include "manape/imported_library.h" // Definition of the ImportedLibrary class
 #include "manape/nt_values.h" // Windows-related #defines flags are declared in this file.
 #include "manape/ordinals.h" // Translation between known ordinals and corresponding function names
+#include "manape/parse_budget.h" // Limits protecting the parser from hostile files
 #include "manape/pe_structs.h" // All typedefs and structs are over there
+#include "manape/relocations.h" // Sorted table of the base relocations
 #include "manape/resources.h"  // Definition of the Resource class
 #include "manape/section.h"    // Definition of the Section class
 #include "manape/utils.h"
@@ -49,8 +57,8 @@ namespace mana::pe {
 
 #pragma region types
 typedef boost::shared_ptr<Section> pSection;
-typedef boost::shared_ptr<std::vector<pSection>> shared_sections;
-typedef boost::shared_ptr<std::vector<pResource>> shared_resources;
+typedef boost::shared_ptr<const std::vector<pSection>> shared_sections;
+typedef boost::shared_ptr<const std::vector<pResource>> shared_resources;
 typedef boost::shared_ptr<const std::vector<pexported_function>> shared_exports;
 typedef boost::shared_ptr<const std::vector<pdebug_directory_entry>> shared_debug_info;
 typedef boost::shared_ptr<const std::vector<pimage_base_relocation>> shared_relocations;
@@ -62,13 +70,24 @@ typedef boost::shared_ptr<const std::vector<pImportedLibrary>> shared_imports;
 typedef boost::shared_ptr<const rich_header> shared_rich_header;
 #pragma endregion
 
+/**
+ *	@brief	The parsed representation of a PE file.
+ *
+ *	All the const methods of this class may be called concurrently from multiple
+ *	threads (i.e. by plugins running in parallel): the file is never written to, reads
+ *	do not rely on a shared file position, and data directories are parsed exactly once
+ *	no matter which thread requests them first.
+ */
 class PE {
 #pragma region private fields
   private:
     std::string _path;
     bool _initialized;
+    bool _headers_only; // Data directories are never parsed (see parse_mode).
     boost::uint64_t _file_size;
-    pFile _file_handle;
+    pFileBuffer _file;
+    pArena _arena; // Parsed structures are allocated here.
+    mutable ParseBudget _budget; // Consumed by the parsers, which stop when exhausted.
 
     /*
     -----------------------------------
@@ -80,34 +99,121 @@ class PE {
     boost::optional<dos_header> _h_dos;
     boost::optional<pe_header> _h_pe;
     boost::optional<image_optional_header> _ioh;
-    std::vector<pcoff_symbol>
-        _coff_symbols; // This debug information is parsed (crudely) but
-    std::vector<pString> _coff_string_table; // not displayed, because that's IDA's job.
-    std::vector<pSection> _sections;
-    std::vector<pImportedLibrary> _imports;
-    boost::optional<image_export_directory> _ied;
-    std::vector<pexported_function> _exports;
-    std::vector<pResource> _resource_table;
-    std::vector<pdebug_directory_entry> _debug_entries;
-    std::vector<pimage_base_relocation>
-        _relocations; // Not displayed either, because of how big it is.
-    boost::optional<image_tls_directory> _tls;
-    boost::optional<image_load_config_directory> _config;
-    boost::optional<delay_load_directory_table> _delay_load_directory_table;
-    std::vector<pwin_certificate> _certificates;
-    boost::optional<rich_header> _rich_header;
+    std::vector<coff_symbol> _coff_symbols; // This debug information is parsed (crudely)
+    ByteView _coff_string_table; // but not displayed, because that's IDA's job.
+    boost::shared_ptr<std::vector<pSection>> _sections;
+    pSectionIndex _section_index; // Built along with _sections, used by rva_to_offset.
+
+    /*
+    ----------------------------------------------------------------
+    Data directories. They are only parsed when they are first requested, hence the
+    mutable qualifiers.
+    Once parsed, they are never modified again: getters hand out the same shared
+    objects instead of copies.
+    ----------------------------------------------------------------
+    */
+    mutable boost::shared_ptr<std::vector<pImportedLibrary>> _imports;
+    mutable boost::optional<image_export_directory> _ied;
+    mutable boost::shared_ptr<std::vector<pexported_function>> _exports;
+    mutable std::unordered_map<std::string, pexported_function>
+        _exports_by_name; // Built along with _exports.
+    mutable boost::shared_ptr<std::vector<pResource>> _resource_table;
+    mutable boost::shared_ptr<std::vector<pdebug_directory_entry>> _debug_entries;
+    // Not displayed either, because of how big it is.
+    mutable pRelocationTable _relocation_table;
+    mutable shared_tls _tls;
+    mutable shared_config _config;
+    mutable shared_dldt _delay_load_directory_table;
+    mutable boost::shared_ptr<std::vector<pwin_certificate>> _certificates;
+    mutable shared_rich_header _rich_header;
+
+    // Guarantee that each directory is parsed exactly once, even when the object is
+    // shared between threads. Imports and delayed imports share the same flag since both
+    // fill _imports.
+    mutable std::once_flag _imports_parsed;
+    mutable std::once_flag _exports_parsed;
+    mutable std::once_flag _resources_parsed;
+    mutable std::once_flag _debug_parsed;
+    mutable std::once_flag _relocations_parsed;
+    mutable std::once_flag _tls_parsed;
+    mutable std::once_flag _config_parsed;
+    mutable std::once_flag _certificates_parsed;
+    mutable std::once_flag _rich_header_parsed;
 #pragma endregion
 
 #pragma region types
   public:
     enum architecture { x86, x64 };
+
+    /**
+     *	@brief	How much of the file should be parsed.
+     *
+     *	FULL:			Everything is available (data directories are parsed on demand).
+     *	HEADERS_ONLY:	Parsing stops after the section table. Data directories are
+     *					reported as empty. Intended for fast triage of large corpora,
+     *					where only a few pages at the beginning of each file are read.
+     */
+    enum parse_mode { FULL, HEADERS_ONLY };
 #pragma endregion
 
 #pragma region public methods
   public:
-    DECLSPEC_MANAPE PE(const std::string &path);
+    DECLSPEC_MANAPE PE(const std::string &path, parse_mode mode = FULL,
+                       const parse_limits &limits = parse_limits());
+
+    /**
+     *	@brief	Parses a PE whose contents have already been loaded.
+     *
+     *	@param	pFileBuffer file The contents of the PE.
+     *	@param	const std::string& name The name under which the PE will be reported
+     *			(i.e. the return value of get_path()).
+     *	@param	parse_mode mode Whether the data directories should be parsed.
+     *	@param	const parse_limits& limits How much work the parser is allowed to do
+     *			on this file, including the directories parsed later on demand.
+     */
+    DECLSPEC_MANAPE PE(pFileBuffer file, const std::string &name,
+                       parse_mode mode = FULL,
+                       const parse_limits &limits = parse_limits());
+
     DECLSPEC_MANAPE virtual ~PE() {}
-    DECLSPEC_MANAPE static boost::shared_ptr<PE> create(const std::string &path);
+    DECLSPEC_MANAPE static boost::shared_ptr<PE>
+    create(const std::string &path, parse_mode mode = FULL,
+           const parse_limits &limits = parse_limits());
+
+    /**
+     *	@brief	Parses a PE located in memory instead of on the filesystem.
+     *
+     *	@param	shared_bytes bytes The bytes of the PE. A reference is kept on the
+     *			vector, which is not copied.
+     *	@param	const std::string& name The name under which the PE will be reported.
+     *	@param	parse_mode mode Whether the data directories should be parsed.
+     *	@param	const parse_limits& limits How much work the parser is allowed to do.
+     *			In-memory samples often come from archives or captures, and deserve
+     *			the same protection as files.
+     *
+     *	@return	A shared PE object. Use is_valid() to check whether parsing succeeded.
+     */
+    DECLSPEC_MANAPE static boost::shared_ptr<PE>
+    from_memory(shared_bytes bytes, const std::string &name = "", parse_mode mode = FULL,
+                const parse_limits &limits = parse_limits());
+
+    /**
+     *	@brief	Parses a PE located in a buffer owned by the caller.
+     *
+     *	/!\ The buffer is not copied: it must remain valid for as long as the returned
+     *	object, or any view / resource obtained from it, is in use!
+     *
+     *	@param	const boost::uint8_t* data The bytes of the PE.
+     *	@param	size_t size The size of the buffer.
+     *	@param	const std::string& name The name under which the PE will be reported.
+     *	@param	parse_mode mode Whether the data directories should be parsed.
+     *	@param	const parse_limits& limits How much work the parser is allowed to do.
+     *
+     *	@return	A shared PE object. Use is_valid() to check whether parsing succeeded.
+     */
+    DECLSPEC_MANAPE static boost::shared_ptr<PE>
+    from_memory(const boost::uint8_t *data, size_t size, const std::string &name = "",
+                parse_mode mode = FULL, const parse_limits &limits = parse_limits());
 
     DECLSPEC_MANAPE boost::uint64_t get_filesize() const;
 
@@ -120,9 +226,7 @@ class PE {
      *
      *	@return	A shared object containing the section information.
      */
-    DECLSPEC_MANAPE shared_sections get_sections() const {
-        return boost::make_shared<std::vector<pSection>>(_sections);
-    }
+    DECLSPEC_MANAPE shared_sections get_sections() const { return _sections; }
 
     /**
      *	@brief	Returns the list of DLLs imported by the PE.
@@ -203,62 +307,116 @@ class PE {
     }
 
     DECLSPEC_MANAPE shared_resources get_resources() const {
-        return _initialized ? boost::make_shared<std::vector<pResource>>(_resource_table)
-                            : shared_resources();
+        if (!_initialized) {
+            return shared_resources();
+        }
+        _parse_directory(_resources_parsed, &PE::_parse_resources);
+        return _resource_table;
     }
 
     DECLSPEC_MANAPE shared_exports get_exports() const {
-        return _initialized
-                   ? boost::make_shared<std::vector<pexported_function>>(_exports)
-                   : shared_exports();
+        if (!_initialized) {
+            return shared_exports();
+        }
+        _parse_directory(_exports_parsed, &PE::_parse_exports);
+        return _exports;
     }
 
+    /**
+     *	@brief	Looks up an exported function by name, in constant time.
+     *
+     *	@param	const std::string& name The exact (case-sensitive) name of the export.
+     *
+     *	@return	The matching export, or nullptr if the PE doesn't export this name.
+     */
+    DECLSPEC_MANAPE pexported_function find_export(const std::string &name) const;
+
+    /**
+     *	@brief	Looks up an exported function by ordinal, in constant time.
+     *
+     *	@param	boost::uint32_t ordinal The ordinal of the export (including the
+     *			directory's Base).
+     *
+     *	@return	The matching export, or nullptr if the PE doesn't export this ordinal.
+     */
+    DECLSPEC_MANAPE pexported_function find_export(boost::uint32_t ordinal) const;
+
     DECLSPEC_MANAPE shared_debug_info get_debug_info() const {
-        return _initialized ? boost::make_shared<std::vector<pdebug_directory_entry>>(
-                                  _debug_entries)
-                            : shared_debug_info();
+        if (!_initialized) {
+            return shared_debug_info();
+        }
+        _parse_directory(_debug_parsed, &PE::_parse_debug);
+        return _debug_entries;
     }
 
-    DECLSPEC_MANAPE shared_relocations get_relocations() const {
-        return _initialized
-                   ? boost::make_shared<std::vector<pimage_base_relocation>>(_relocations)
-                   : shared_relocations();
+    /**
+     *	@brief	Returns the base relocations as a table sorted by RVA, which can be
+     *			queried efficiently (i.e. to check whether an address is relocated).
+     */
+    DECLSPEC_MANAPE pRelocationTable get_relocation_table() const {
+        if (!_initialized) {
+            return pRelocationTable();
+        }
+        _parse_directory(_relocations_parsed, &PE::_parse_relocations);
+        return _relocation_table;
     }
 
+    /**
+     *	@brief	Returns the base relocations grouped in IMAGE_BASE_RELOCATION blocks.
+     *
+     *	Deprecated: this is kept for existing callers, and get_relocation_table() should
+     *	be used instead. The blocks are rebuilt from the RelocationTable on each call, so
+     *	they don't contain the IMAGE_REL_BASED_ABSOLUTE padding entries, and BlockSize
+     *	is computed without them.
+     */
+    DECLSPEC_MANAPE shared_relocations get_relocations() const;
+
     DECLSPEC_MANAPE shared_tls get_tls() const {
-        return (_initialized && _tls) ? boost::make_shared<image_tls_directory>(*_tls)
-                                      : shared_tls();
+        if (!_initialized) {
+            return shared_tls();
+        }
+        _parse_directory(_tls_parsed, &PE::_parse_tls);
+        return _tls;
     }
 
     DECLSPEC_MANAPE shared_config get_config() const {
-        return (_initialized && _config)
-                   ? boost::make_shared<image_load_config_directory>(*_config)
-                   : shared_config();
+        if (!_initialized) {
+            return shared_config();
+        }
+        _parse_directory(_config_parsed, &PE::_parse_config);
+        return _config;
     }
 
     DECLSPEC_MANAPE shared_dldt get_delay_load_table() const {
-        return (_initialized && _delay_load_directory_table)
-                   ? boost::make_shared<delay_load_directory_table>(
-                         *_delay_load_directory_table)
-                   : shared_dldt();
+        if (!_initialized) {
+            return shared_dldt();
+        }
+        _ensure_imports_parsed();
+        return _delay_load_directory_table;
     }
 
     DECLSPEC_MANAPE shared_certificates get_certificates() const {
-        return _initialized
-                   ? boost::make_shared<shared_certificates::element_type>(_certificates)
-                   : boost::make_shared<shared_certificates::element_type>();
+        if (!_initialized) {
+            return boost::make_shared<shared_certificates::element_type>();
+        }
+        _parse_directory(_certificates_parsed, &PE::_parse_certificates);
+        return _certificates;
     }
 
     DECLSPEC_MANAPE shared_rich_header get_rich_header() const {
-        return (_initialized && _rich_header)
-                   ? boost::make_shared<rich_header>(*_rich_header)
-                   : shared_rich_header();
+        if (!_initialized) {
+            return shared_rich_header();
+        }
+        _parse_directory(_rich_header_parsed, &PE::_parse_rich_header);
+        return _rich_header;
     }
 
     DECLSPEC_MANAPE shared_imports get_imports() const {
-        return (_initialized)
-                   ? boost::make_shared<std::vector<pImportedLibrary>>(_imports)
-                   : shared_imports();
+        if (!_initialized) {
+            return shared_imports();
+        }
+        _ensure_imports_parsed();
+        return _imports;
     }
 
     /**
@@ -275,6 +433,27 @@ class PE {
      */
     DECLSPEC_MANAPE bool is_valid() const { return _initialized; }
 
+    /**
+     *	@brief	Returns the mode in which the PE was parsed.
+     */
+    DECLSPEC_MANAPE parse_mode get_parse_mode() const {
+        return _headers_only ? HEADERS_ONLY : FULL;
+    }
+
+    /**
+     *	@brief	Tells whether some structures were left out because the file exceeded
+     *			its parse_limits.
+     *
+     *	Since data directories are parsed on demand, this only reflects the directories
+     *	which have been requested so far.
+     */
+    DECLSPEC_MANAPE bool is_truncated() const { return _budget.is_truncated(); }
+
+    /**
+     *	@brief	Details why and where the parsing was truncated (see is_truncated()).
+     */
+    DECLSPEC_MANAPE truncation get_truncation() const { return _budget.get_truncation(); }
+
     /**
      *	@brief	Provides direct access to the file's bytes.
      *
@@ -301,6 +480,26 @@ class PE {
      */
     DECLSPEC_MANAPE shared_bytes get_overlay_bytes(size_t size = INT_MAX) const;
 
+    /**
+     *	@brief	Provides direct access to the file's bytes, without copying them.
+     *
+     *	@param	boost::uint64_t size If specified, only the [size] first bytes of the file
+     *			will be provided. By default, the whole file is covered.
+     *
+     *	@return	A view over the bytes of the file.
+     */
+    DECLSPEC_MANAPE ByteView get_raw_view(size_t size = INT_MAX) const;
+
+    /**
+     *	@brief	Returns the bytes of the file located after the PE, without copying them.
+     *
+     *	@param	boost::uint64_t size If specified, only the [size] first bytes of the
+     *			overlay will be provided.
+     *
+     *	@return	A view over the overlay bytes, which is empty if the PE has no overlay.
+     */
+    DECLSPEC_MANAPE ByteView get_overlay_view(size_t size = INT_MAX) const;
+
     /**
      *	@brief	The delete operator. "new" had to be re-implemented in order to make it
      *private.
@@ -336,10 +535,18 @@ class PE {
 
     /**
      * Reads the (optional) PE COFF symbols of an executable.
-     * /!\ This relies on the information gathered in _parse_pe_header.
+     * /!\ This relies on the information gathered in _parse_pe_header and
+     * _parse_section_table.
      */
     bool _parse_coff_symbols();
 
+    /**
+     * Locates the (optional) COFF string table, which follows the symbols. It is kept
+     * as a single view over the file, in which strings are looked up by offset.
+     * /!\ This relies on the information gathered in _parse_pe_header.
+     */
+    bool _parse_coff_string_table();
+
     /**
      *	@brief	Parses the IMAGE_OPTIONAL_HEADER structure of a PE.
      *	/!\ This relies on the information gathered in _parse_pe_header.
@@ -353,18 +560,28 @@ class PE {
     bool _parse_section_table();
 
     /**
-     *	@brief	Courtesy function used to parse all the PE directories (imports, exports,
-     *resources, ...).
-     *	/!\ This relies on the information gathered in _parse_image_optional_header.
+     *	@brief	Runs a directory parser, unless it already ran or the PE was opened in
+     *			HEADERS_ONLY mode (in which case the directory is left empty).
+     *
+     *	@param	std::once_flag& flag The flag associated to the directory.
+     *	@param	bool (PE::*parser)() const The function parsing the directory.
+     */
+    void _parse_directory(std::once_flag &flag, bool (PE::*parser)() const) const;
+
+    /**
+     *	@brief	Parses the imports and delayed imports if this hasn't been done yet.
+     *
+     *	Implemented in imports.cpp.
      */
-    bool _parse_directories();
+    void _ensure_imports_parsed() const;
 
     /**
-     *	@brief	Parses a Hint/Name table.
+     *	@brief	Parses the Hint/Name table of a function imported by name.
      *
      *	Implemented in imports.cpp.
      */
-    bool _parse_hint_name_table(pimport_lookup_table import) const;
+    bool _parse_hint_name_table(const FileCursor &cursor,
+                                pimport_lookup_table import) const;
 
     /**
      *	@brief	Parses an IMPORT_LOOKUP_TABLE.
@@ -376,90 +593,90 @@ class PE {
     /**
      *	@brief	Parses the imports of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_image_optional_header.
      *
      *	Implemented in imports.cpp
      */
-    bool _parse_imports();
+    bool _parse_imports() const;
 
     /**
      *	@brief	Parses the delayed imports of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_image_optional_header.
      *
      *	Implemented in imports.cpp
      */
-    bool _parse_delayed_imports();
+    bool _parse_delayed_imports() const;
 
     /**
      *	@brief	Parses the exports of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_image_optional_header.
      */
-    bool _parse_exports();
+    bool _parse_exports() const;
 
     /**
      *	@brief	Parses the resources of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      *
      *	Implemented in resources.cpp
      */
-    bool _parse_resources();
+    bool _parse_resources() const;
 
     /**
      *	@brief	Parses the relocation table of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      */
-    bool _parse_relocations();
+    bool _parse_relocations() const;
 
     /**
      *	@brief	Parses the Thread Local Storage callback table of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      */
-    bool _parse_tls();
+    bool _parse_tls() const;
 
     /**
      *	@brief	Parses the Load Configuration of a PE.
      *
-     *  Included in the _parse_directories call.
+     *  Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      */
-    bool _parse_config();
+    bool _parse_config() const;
 
     /**
      *	@brief	Parses the debug information of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      *
      *	Implemented in resources.cpp
      */
-    bool _parse_debug();
+    bool _parse_debug() const;
 
     /**
      *	@brief	Parses the certificate information (Authenticode) of a PE.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      */
-    bool _parse_certificates();
+    bool _parse_certificates() const;
 
     /**
      *	@brief	Parses the opaque RICH header.
      *
-     *	Included in the _parse_directories call.
+     *	Called the first time this information is requested.
      *	/!\ This relies on the information gathered in _parse_pe_header.
      */
-    bool _parse_rich_header();
+    bool _parse_rich_header() const;
 
     /**
      *	@brief	Translates a Virtual Address (*not relative to the image base*) into an
@@ -473,17 +690,19 @@ class PE {
     unsigned int _va_to_offset(boost::uint64_t va) const;
 
     /**
-     *	@brief	Moves the file cursor to the target directory.
+     *	@brief	Moves a file cursor to the target directory.
      *
      *	@param	int directory	The directory to reach, i.e. IMAGE_DIRECTORY_ENTRY_EXPORT.
+     *	@param	FileCursor& cursor	The cursor to move.
      *
      *	@return	Whether the directory was successfully reached.
      */
-    bool _reach_directory(int directory) const;
+    bool _reach_directory(int directory, FileCursor &cursor) const;
 
     /**
-     *	@brief	Reads an image_resource_directory at the current position in a file.
+     *	@brief	Reads an image_resource_directory at the current position of a cursor.
      *
+     *	@param	FileCursor& cursor The cursor to read from.
      *	@param	image_resource_directory& dir The structure to fill.
      *	@param	unsigned int offset The offset at which to jump before reading the
      *directory. The offset is relative to the beginning of the resource "section" (NOT a
@@ -493,7 +712,7 @@ class PE {
      *
      *	@return	Whether a structure was successfully read.
      */
-    bool _read_image_resource_directory(image_resource_directory &dir,
+    bool _read_image_resource_directory(FileCursor &cursor, image_resource_directory &dir,
                                         unsigned int offset = 0) const;
 #pragma endregion
 };
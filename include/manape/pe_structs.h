@@ -163,6 +163,8 @@ typedef boost::shared_ptr<image_export_directory> pexport_image_directory;
 
 // ----------------------------------------------------------------------------
 
+// Packed so that the symbol table can be copied from the file in a single operation.
+#pragma pack(push, 1)
 typedef struct coff_symbol_t {
     boost::uint8_t Name[8];
     boost::uint32_t Value;
@@ -171,6 +173,8 @@ typedef struct coff_symbol_t {
     boost::uint8_t StorageClass;
     boost::uint8_t NumberOfAuxSymbols;
 } coff_symbol;
+#pragma pack(pop)
+static_assert(sizeof(coff_symbol) == 18, "COFF symbols are 18 bytes long.");
 typedef boost::shared_ptr<coff_symbol> pcoff_symbol;
 
 // ----------------------------------------------------------------------------
@@ -202,7 +206,8 @@ typedef struct image_resource_directory_t {
     boost::uint16_t minorVersion;
     boost::uint16_t NumberOfNamedEntries;
     boost::uint16_t NumberOfIdEntries;
-    std::vector<pimage_resource_directory_entry> Entries;
+    // Non-standard! Only used while walking the tree, so the entries are plain values.
+    std::vector<image_resource_directory_entry> Entries;
 } image_resource_directory;
 typedef boost::shared_ptr<image_resource_directory> pimage_resource_directory;
 
@@ -330,6 +335,8 @@ typedef struct pdb_info_t {
 
 // ----------------------------------------------------------------------------
 
+// A block of base relocations. The parser stores the TypeOffset entries directly in the
+// RelocationTable: TypesOffsets is only filled by PE::get_relocations().
 typedef struct image_base_relocation_t {
     boost::uint32_t PageRVA;
     boost::uint32_t BlockSize;
@@ -337,6 +344,13 @@ typedef struct image_base_relocation_t {
 } image_base_relocation;
 typedef boost::shared_ptr<image_base_relocation_t> pimage_base_relocation;
 
+// A single TypeOffset entry of an IMAGE_BASE_RELOCATION, with the RVA of its block.
+typedef struct relocation_t {
+    boost::uint32_t PageRVA;
+    boost::uint16_t Offset; // The low 12 bits of the TypeOffset.
+    boost::uint8_t Type;    // The high 4 bits of the TypeOffset.
+} relocation;
+
 // ----------------------------------------------------------------------------
 
 typedef struct image_debug_misc_t {
@@ -434,6 +448,16 @@ typedef struct rich_header_t {
     boost::uint32_t file_offset; // We keep a reference of where the structure starts.
     // Structure : id, product_id, count
     std::vector<std::tuple<boost::uint16_t, boost::uint16_t, boost::uint32_t>> values;
+
+    // Non-standard fields, computed while parsing.
+    // The linker uses a checksum of the DOS header and the @comp.ids as the XOR key:
+    // the two values differ if the headers were modified.
+    boost::uint32_t checksum;
+    // Manalyze-specific 64-bit FNV-1a hash of the decoded header, from "DanS" to "Rich"
+    // (excluded). Samples built with the same toolchain share it. This is NOT the RichPE
+    // hash (an MD5 of the decoded @comp.ids) reported by VirusTotal or YARA's
+    // pe.rich_signature: it can only be compared with values computed by Manalyze.
+    boost::uint64_t fnv_hash;
 } rich_header;
 
 } // namespace mana::pe
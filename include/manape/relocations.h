@@ -0,0 +1,97 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <utility>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "manape/export.h"
+#include "manape/pe_structs.h"
+
+#ifndef __MANAPE_RELOCATIONS__
+#define __MANAPE_RELOCATIONS__ 1
+
+namespace mana::pe {
+
+/**
+ *	@brief	The base relocations of a PE, stored in a single array sorted by RVA.
+ *
+ *	The IMAGE_BASE_RELOCATION blocks are flattened into individual relocations, so that
+ *	questions such as "is this address relocated?" can be answered with a binary search
+ *	instead of walking every block.
+ */
+class RelocationTable {
+  public:
+    typedef std::vector<relocation>::const_iterator const_iterator;
+
+    DECLSPEC_MANAPE RelocationTable() {}
+
+    /**
+     *	@brief	Builds the table.
+     *
+     *	@param	std::vector<relocation> relocations The relocations of the PE, in any
+     *			order. IMAGE_REL_BASED_ABSOLUTE entries, which are only used as padding,
+     *			are discarded.
+     */
+    DECLSPEC_MANAPE explicit RelocationTable(std::vector<relocation> relocations);
+
+    /**
+     *	@brief	Tells whether the loader modifies the byte located at a given RVA when
+     *			the image is rebased.
+     *
+     *	@param	boost::uint32_t rva The address to check. It does not need to be the start
+     *			of the relocated value.
+     */
+    DECLSPEC_MANAPE bool is_relocated(boost::uint32_t rva) const;
+
+    /**
+     *	@brief	Returns the relocations located in a range of addresses.
+     *
+     *	@param	boost::uint32_t start The first RVA of the range.
+     *	@param	boost::uint32_t end The RVA following the end of the range.
+     *
+     *	@return	A pair of iterators delimiting the relocations whose RVA is in
+     *			[start, end), sorted by RVA.
+     */
+    DECLSPEC_MANAPE std::pair<const_iterator, const_iterator>
+    find_range(boost::uint32_t start, boost::uint32_t end) const;
+
+    /**
+     *	@brief	Returns the number of bytes patched by a relocation (i.e. 4 for
+     *			IMAGE_REL_BASED_HIGHLOW).
+     */
+    DECLSPEC_MANAPE static unsigned int get_relocated_size(const relocation &r);
+
+    DECLSPEC_MANAPE static boost::uint32_t get_rva(const relocation &r) {
+        return r.PageRVA + r.Offset;
+    }
+
+    DECLSPEC_MANAPE size_t size() const { return _relocations.size(); }
+    DECLSPEC_MANAPE bool empty() const { return _relocations.empty(); }
+    DECLSPEC_MANAPE const_iterator begin() const { return _relocations.begin(); }
+    DECLSPEC_MANAPE const_iterator end() const { return _relocations.end(); }
+
+  private:
+    std::vector<relocation> _relocations; // Sorted by RVA.
+};
+typedef boost::shared_ptr<const RelocationTable> pRelocationTable;
+
+} // namespace mana::pe
+
+#endif // __MANAPE_RELOCATIONS__
@@ -15,21 +15,23 @@ You should have received a copy of the GNU General Public License
 along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <boost/cstdint.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/optional.hpp>
 #include <boost/shared_array.hpp>
 #include <boost/system/api_config.hpp>
 
-#if !defined(WINDOWS)
-#include <sys/stat.h>
-#endif
-
+#include "manape/byte_view.h"
+#include "manape/file_buffer.h"
+#include "manape/file_cursor.h"
 #include "manape/pe_structs.h"
 #include "manape/utils.h"
 
@@ -38,6 +40,8 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace mana::pe {
 
+class IconIndex;
+
 class Resource {
 #pragma region private fields
   private:
@@ -56,32 +60,43 @@ class Resource {
 
     // These fields do not describe the PE structure.
     unsigned int _offset_in_file;
-    std::string _path_to_pe;
+    pFileBuffer _file;
+
+    /**
+     *	@brief	Creates a cursor pointing to the resource bytes. It cannot read past the
+     *			end of the resource.
+     *
+     *	@return	A cursor correctly set, or boost::none if there was an error.
+     */
+    boost::optional<FileCursor> _reach_data() const;
+
+    // VS_VERSIONINFO resources are parsed once, the first time they are interpreted.
+    mutable std::once_flag _version_info_parsed;
+    mutable pversion_info _version_info;
 
     /**
-     *	@brief	Opens the PE file and sets the cursor to the resource bytes.
+     *	@brief	Parses the resource's bytes as a VS_VERSIONINFO structure.
      *
-     *	@return	A file object with its cursor correctly set, or NULL if there was an
-     *error.
+     *	@return	The parsed structure, or a null pointer if it is malformed.
      */
-    FILE *_reach_data() const;
+    pversion_info _parse_version_info() const;
 #pragma endregion
 
 #pragma region public methods
   public:
     DECLSPEC_MANAPE Resource(std::string type, std::string name, std::string language,
              boost::uint32_t codepage, boost::uint32_t size, boost::uint32_t timestamp,
-             boost::uint32_t offset_in_file, std::string path_to_pe)
+             boost::uint32_t offset_in_file, pFileBuffer file)
         : _type(std::move(type)), _name(std::move(name)), _language(std::move(language)),
           _codepage(codepage), _size(size), _timestamp(timestamp),
-          _offset_in_file(offset_in_file), _path_to_pe(std::move(path_to_pe)), _id(0) {}
+          _offset_in_file(offset_in_file), _file(std::move(file)), _id(0) {}
 
     DECLSPEC_MANAPE Resource(std::string type, boost::uint32_t id, std::string language,
              boost::uint32_t codepage, boost::uint32_t size, boost::uint32_t timestamp,
-             boost::uint32_t offset_in_file, std::string path_to_pe)
+             boost::uint32_t offset_in_file, pFileBuffer file)
         : _type(std::move(type)), _name(), _language(std::move(language)),
           _codepage(codepage), _offset_in_file(offset_in_file), _size(size),
-          _timestamp(timestamp), _path_to_pe(std::move(path_to_pe)), _id(id) {}
+          _timestamp(timestamp), _file(std::move(file)), _id(id) {}
 
     DECLSPEC_MANAPE virtual ~Resource() = default;
 
@@ -99,7 +114,8 @@ class Resource {
     DECLSPEC_MANAPE boost::uint32_t get_timestamp() const { return _timestamp; }
 
     DECLSPEC_MANAPE double get_entropy() const {
-        return utils::shannon_entropy(*get_raw_data());
+        ByteView view = get_raw_view();
+        return utils::shannon_entropy(view.data(), view.size());
     }
 
     DECLSPEC_MANAPE pString get_name() const {
@@ -120,6 +136,14 @@ class Resource {
      */
     DECLSPEC_MANAPE shared_bytes get_raw_data() const;
 
+    /**
+     *	@brief	Retrieves the raw bytes of the resource without copying them.
+     *
+     *	@return	A view pointing to the resource's data inside the file. It may be empty
+     *			if the resource could not be read.
+     */
+    DECLSPEC_MANAPE ByteView get_raw_view() const;
+
     /**
      *	@brief	Interprets the resource as a given type.
      *
@@ -129,7 +153,7 @@ class Resource {
      *	* const_shared_strings for RT_STRING
      *	* pgroup_icon_directory_t for RT_GROUP_ICON and RT_GROUP_CURSOR
      *	* pbitmap for RT_BITMAP
-     *  * pversion_info for RT_VERSION
+     *  * pversion_info for RT_VERSION (parsed once, then shared between callers)
      *	* shared_bytes for all resource types (equivalent to  get_raw_data()).
      *
      *	@tparam	T The type into which the resource should be interpreted.
@@ -158,10 +182,54 @@ class Resource {
     DECLSPEC_MANAPE bool
     icon_extract(const boost::filesystem::path &destination,
                  const std::vector<boost::shared_ptr<Resource>> &resources);
+
+    /**
+     * @brief   Same as above, using an index of the PE's icons built beforehand. Use it
+     * when extracting many icons from the same file.
+     */
+    DECLSPEC_MANAPE bool icon_extract(const boost::filesystem::path &destination,
+                                      const IconIndex &index);
 #pragma endregion
 };
 typedef boost::shared_ptr<Resource> pResource;
 
+/**
+ *	@brief	Indexes the RT_ICON and RT_CURSOR resources of a PE by type and ID, so that
+ *			the images referenced by icon groups can be located without going through
+ *			all the resources every time.
+ */
+class IconIndex {
+  public:
+    /**
+     *	@param	const std::vector<pResource>& resources The resources of the PE.
+     */
+    DECLSPEC_MANAPE explicit IconIndex(const std::vector<pResource> &resources);
+
+    /**
+     *	@brief	Finds the image referenced by an icon group entry.
+     *
+     *	@param	boost::uint16_t type The type of the group (group_icon_directory::Type):
+     *			1 for icons, 2 for cursors.
+     *	@param	boost::uint32_t id The ID of the RT_ICON or RT_CURSOR.
+     *
+     *	@return	The first resource matching the type and ID, or a null pointer.
+     */
+    DECLSPEC_MANAPE pResource find(boost::uint16_t type, boost::uint32_t id) const;
+
+    /**
+     *	@brief	Returns the number of resources (of any type) the index was built from.
+     */
+    DECLSPEC_MANAPE size_t get_resource_count() const { return _resource_count; }
+
+  private:
+    static boost::uint64_t _make_key(boost::uint16_t type, boost::uint32_t id) {
+        return (static_cast<boost::uint64_t>(type) << 32) | id;
+    }
+
+    std::unordered_map<boost::uint64_t, pResource> _index;
+    size_t _resource_count;
+};
+
 /**
  *	@brief	Recreates a .ico from resources.
  *
@@ -177,17 +245,24 @@ typedef boost::shared_ptr<Resource> pResource;
 DECLSPEC_MANAPE shared_bytes reconstruct_icon(pgroup_icon_directory directory,
                                               const std::vector<pResource> &resources);
 
+/**
+ *	@brief	Same as above, using an index of the PE's icons built beforehand.
+ */
+DECLSPEC_MANAPE shared_bytes reconstruct_icon(pgroup_icon_directory directory,
+                                              const IconIndex &index);
+
 /**
  *	@brief	Parses a VERSION_INFO_HEADER, which is not a standard structure but does come
  *up a lot.
  *
  *	@param	vs_version_info_header& header The structure to fill.
- *	@param	FILE* f An opened file to read from. The cursor has to be set to the right
+ *	@param	FileCursor& cursor The cursor to read from. It has to be set to the right
  *offset and will be updated.
  *
  *	@return	Whether the structure was read successfully.
  */
-DECLSPEC_MANAPE bool parse_version_info_header(vs_version_info_header &header, FILE *f);
+DECLSPEC_MANAPE bool parse_version_info_header(vs_version_info_header &header,
+                                               FileCursor &cursor);
 
 } // namespace mana::pe
 
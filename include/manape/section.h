@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License
 along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <atomic>
 #include <stdio.h>
 #include <vector>
 
@@ -23,7 +24,9 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 #include <boost/make_shared.hpp>
 #include <boost/system/api_config.hpp>
 
+#include "manape/byte_view.h"
 #include "manape/export.h"
+#include "manape/file_buffer.h"
 #include "manape/pe_structs.h"
 #include "manape/utils.h"
 #include "types.h"
@@ -51,8 +54,8 @@ class Section {
     boost::uint16_t _number_of_line_numbers;
     boost::uint32_t _characteristics;
 
-    // Handle to the file on the filesystem.
-    pFile _file_handle;
+    // The contents of the executable.
+    pFileBuffer _file;
     // Size of the file. This is used to reject sections with a wrong size.
     boost::uint64_t _file_size;
 #pragma endregion
@@ -64,13 +67,13 @@ class Section {
      *
      *	@param	const image_section_header& header The structure on which the section will
      *be based.
-     *	@param	pFile handle An open handle to the executable on the filesystem.
-     *	@param	const std::vector<pString>& coff_string_table An optional COFF string
-     *table, in case section names are located in it.
+     *	@param	pFileBuffer file The contents of the executable.
+     *	@param	const ByteView& coff_string_table An optional COFF string table, in
+     *case section names are located in it.
      */
     DECLSPEC_MANAPE
-    Section(const image_section_header &header, pFile handle, boost::uint64_t file_size,
-            const std::vector<pString> &coff_string_table = std::vector<pString>());
+    Section(const image_section_header &header, pFileBuffer file,
+            boost::uint64_t file_size, const ByteView &coff_string_table = ByteView());
 
     DECLSPEC_MANAPE virtual ~Section() {}
 
@@ -85,6 +88,14 @@ class Section {
      */
     DECLSPEC_MANAPE shared_bytes get_raw_data() const;
 
+    /**
+     *	@brief	Returns the raw bytes of the section without copying them.
+     *
+     *	@return	A view pointing to the section's data inside the file. If an error
+     *occurs, the view will be empty.
+     */
+    DECLSPEC_MANAPE ByteView get_raw_view() const;
+
     DECLSPEC_MANAPE pString get_name() const {
         return boost::make_shared<std::string>(_name);
     }
@@ -124,7 +135,8 @@ class Section {
     }
 
     DECLSPEC_MANAPE double get_entropy() const {
-        return mana::utils::shannon_entropy(*get_raw_data());
+        ByteView view = get_raw_view();
+        return mana::utils::shannon_entropy(view.data(), view.size());
     }
 #pragma endregion
 };
@@ -156,6 +168,44 @@ DECLSPEC_MANAPE bool is_address_in_section(boost::uint64_t rva, pSection section
 DECLSPEC_MANAPE pSection find_section(unsigned int rva,
                                       const std::vector<pSection> &section_list);
 
+/**
+ *	@brief	A lookup structure which finds the section containing an RVA in logarithmic
+ *			time.
+ *
+ *	The address space is cut into contiguous ranges, each of them associated with the
+ *	section find_section would return for any address it contains. Lookups are then a
+ *	binary search, and consecutive lookups in the same range (i.e. while parsing a
+ *	directory) are answered without searching at all.
+ */
+class SectionIndex {
+  public:
+    /**
+     *	@brief	Builds the index.
+     *
+     *	@param	const std::vector<pSection>& sections The sections of the PE, in the order
+     *			of the section table (which decides which one wins when they overlap).
+     */
+    DECLSPEC_MANAPE explicit SectionIndex(const std::vector<pSection> &sections);
+
+    /**
+     *	@brief	Finds the section containing a given RVA.
+     *
+     *	This function is equivalent to find_section, and is safe to call from multiple
+     *	threads.
+     *
+     *	@param	boost::uint64_t rva The address whose section we want to identify.
+     *
+     *	@return	The section containing the address, or NULL if there is none.
+     */
+    DECLSPEC_MANAPE pSection find(boost::uint64_t rva) const;
+
+  private:
+    std::vector<boost::uint64_t> _starts; // Sorted start of each range.
+    std::vector<pSection> _owners; // The section matching each range (may be NULL).
+    mutable std::atomic<size_t> _last_hit; // The range of the previous lookup.
+};
+typedef boost::shared_ptr<const SectionIndex> pSectionIndex;
+
 } // namespace mana::pe
 
 #endif // __MANEPE_SECTION__
@@ -31,6 +31,7 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "manacommons/utf8/utf8.h" // Used to convert windows UTF-16 strings into UTF-8
 #include "manape/export.h"
+#include "manape/file_cursor.h"
 #include "types.h"
 
 #ifndef __MANAPE_UTILS__
@@ -134,6 +135,23 @@ DECLSPEC_MANAPE bool read_string_at_offset(FILE *f, unsigned int offset, std::st
 
 // ----------------------------------------------------------------------------
 
+/**
+ *	@brief	Overloads of the functions above which read from a FileCursor instead of a
+ *			FILE*. They behave identically and update the cursor in the same way, except
+ *			for read_string_at_offset which leaves the cursor untouched.
+ */
+DECLSPEC_MANAPE std::string read_ascii_string(pe::FileCursor &cursor,
+                                              unsigned int max_bytes = 0);
+DECLSPEC_MANAPE std::string read_prefixed_unicode_string(pe::FileCursor &cursor);
+DECLSPEC_MANAPE std::wstring read_prefixed_unicode_wstring(pe::FileCursor &cursor);
+DECLSPEC_MANAPE std::string read_unicode_string(pe::FileCursor &cursor,
+                                                unsigned int max_bytes = 0);
+DECLSPEC_MANAPE bool read_string_at_offset(const pe::FileCursor &cursor,
+                                           unsigned int offset, std::string &out,
+                                           bool unicode = false);
+
+// ----------------------------------------------------------------------------
+
 /**
  *	@brief	Calculates the entropy of a byte stream.
  *
@@ -145,6 +163,69 @@ DECLSPEC_MANAPE bool read_string_at_offset(FILE *f, unsigned int offset, std::st
  */
 DECLSPEC_MANAPE double shannon_entropy(const std::vector<boost::uint8_t> &bytes);
 
+/**
+ *	@brief	Calculates the entropy of a buffer.
+ *
+ *	This overload can work on data which does not live in a vector, such as a ByteView
+ *	pointing into the file.
+ *
+ *	@param	const boost::uint8_t* data The bytes to work on.
+ *	@param	size_t size The number of bytes.
+ *
+ *	@return	The entropy of the buffer.
+ */
+DECLSPEC_MANAPE double shannon_entropy(const boost::uint8_t *data, size_t size);
+
+/**
+ *	@brief	Counts the occurrences of each byte value in a buffer.
+ *
+ *	The implementation (AVX2, SSE2 or portable) is selected at runtime, depending on
+ *	what the CPU supports.
+ *
+ *	@param	const boost::uint8_t* data The bytes to count.
+ *	@param	size_t size The number of bytes.
+ *	@param	boost::uint64_t* histogram An array of 256 counters which receives the result.
+ */
+DECLSPEC_MANAPE void byte_histogram(const boost::uint8_t *data, size_t size,
+                                    boost::uint64_t *histogram);
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Looks for a value among the (little-endian) DWORDs of a buffer.
+ *
+ *	On x86 processors, four DWORDs are compared at a time.
+ *
+ *	@param	const boost::uint8_t* data The buffer, read as an array of DWORDs.
+ *	@param	size_t count The number of DWORDs in the buffer.
+ *	@param	boost::uint32_t value The value to look for.
+ *
+ *	@return	The index of the first matching DWORD, or count if there is none.
+ */
+DECLSPEC_MANAPE size_t find_dword(const boost::uint8_t *data, size_t count,
+                                  boost::uint32_t value);
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	The size of the buffer filled by format_timestamp, including the final NULL
+ *			character.
+ */
+const size_t TIMESTAMP_BUFFER_SIZE = sizeof("YYYY-Mon-DD HH:MM:SS");
+
+/**
+ *	@brief	Formats a POSIX timestamp like timestamp_to_string, without allocating any
+ *			memory.
+ *
+ *	@param	int64_t timestamp The timestamp to format.
+ *	@param	char* buffer The destination of the NULL-terminated string. It must be at
+ *			least TIMESTAMP_BUFFER_SIZE bytes long.
+ *
+ *	@return	Whether the timestamp could be formatted. Only years between 1400 and 9999
+ *			are supported.
+ */
+DECLSPEC_MANAPE bool format_timestamp(boost::int64_t timestamp, char *buffer);
+
 // ----------------------------------------------------------------------------
 
 /**
@@ -158,6 +239,20 @@ DECLSPEC_MANAPE pString timestamp_to_string(boost::uint64_t epoch_timestamp);
 
 // ----------------------------------------------------------------------------
 
+/**
+ *	@brief	Converts a DosDate timestamp into a POSIX timestamp.
+ *
+ *	Invalid DosDates are assumed to be POSIX timestamps already, as some compilers
+ *	generate those instead.
+ *
+ *	@param	uint32_t dosdate The timestamp to convert.
+ *
+ *	@return	The number of seconds elapsed since 1970-01-01 00:00:00 UTC.
+ */
+DECLSPEC_MANAPE boost::int64_t dosdate_to_posix(boost::uint32_t dosdate);
+
+// ----------------------------------------------------------------------------
+
 /**
  *	@brief	Converts a DosDate timestamp into a boost::time object.
  *
@@ -15,6 +15,8 @@
     along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <atomic>
+
 #include "manacommons/color.h"
 #include "portability.h"
 
@@ -100,10 +102,11 @@ std::ostream &print_colored_text(const std::string &text, Color c, std::ostream
 }
 
 bool is_log_cap_reached() {
-    static unsigned int log_count = 0;
-    if (++log_count < LOG_CAP) {
+    static std::atomic<unsigned int> log_count(0); // Plugins may log concurrently.
+    unsigned int count = ++log_count;
+    if (count < LOG_CAP) {
         return false;
-    } else if (log_count == LOG_CAP) {
+    } else if (count == LOG_CAP) {
         PRINT_ERROR << "Logging cap reached. Further verbose warnings will be ignored."
                     << std::endl;
     }
@@ -56,4 +56,16 @@ DECLSPEC_MANACOMMONS const std::string bytes_to_hex(const void *data, size_t len
     return std::string("bytes_to_hex is not implemented yet");
 }
 
+DECLSPEC_MANACOMMONS const_shared_strings hash_bytes(const std::vector<pHash> &digests,
+                                              const boost::uint8_t *data, size_t size) {
+    auto res = boost::make_shared<std::vector<std::string>>();
+    for (const auto &digest : digests) {
+        if (digest == nullptr) {
+            return boost::make_shared<std::vector<std::string>>();
+        }
+        res->push_back((*digest)(data, size));
+    }
+    return res;
+}
+
 }; // namespace mana::crypto
@@ -0,0 +1,75 @@
+/*
+    This file is part of Manalyze.
+
+    Manalyze is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Manalyze is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "manape/arena.h"
+
+namespace mana::pe {
+
+Arena::Arena(bool pooled) : _pooled(pooled), _current(nullptr), _remaining(0) {}
+
+// ----------------------------------------------------------------------------
+
+Arena::~Arena() {
+    // Destroying an object may release pointers to other objects of the arena. Since
+    // they share the arena's reference count, which already reached zero, this has no
+    // effect.
+    for (auto it = _destructors.rbegin(); it != _destructors.rend(); ++it) {
+        it->second(it->first);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void *Arena::allocate(size_t size, size_t alignment) {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // Big objects get a chunk of their own, so that the current one can still be used.
+    if (size > CHUNK_SIZE / 4) {
+        _chunks.emplace_back(new boost::uint8_t[size]);
+        return _chunks.back().get();
+    }
+
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(_current) % alignment) %
+                     alignment;
+    if (_current == nullptr || padding + size > _remaining) {
+        _chunks.emplace_back(new boost::uint8_t[CHUNK_SIZE]);
+        _current = _chunks.back().get();
+        _remaining = CHUNK_SIZE;
+        padding = 0; // new[] returns memory suitably aligned for any type.
+    }
+
+    void *res = _current + padding;
+    _current += padding + size;
+    _remaining -= padding + size;
+    return res;
+}
+
+// ----------------------------------------------------------------------------
+
+void Arena::on_destruction(void *object, void (*destroy)(void *)) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _destructors.emplace_back(object, destroy);
+}
+
+// ----------------------------------------------------------------------------
+
+size_t Arena::get_chunk_count() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _chunks.size();
+}
+
+} // namespace mana::pe
@@ -0,0 +1,226 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#include <boost/make_shared.hpp>
+
+#if defined BOOST_WINDOWS_API
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "manacommons/color.h"
+#include "manape/file_buffer.h"
+
+namespace mana::pe {
+
+FileBuffer::FileBuffer()
+    : _data(nullptr), _size(0), _mapped_address(nullptr), _fd(-1), _mtime(0) {}
+
+// ----------------------------------------------------------------------------
+
+FileBuffer::~FileBuffer() {
+    if (_mapped_address == nullptr) {
+        return;
+    }
+#if defined BOOST_WINDOWS_API
+    ::UnmapViewOfFile(_mapped_address);
+#else
+    ::munmap(_mapped_address, static_cast<size_t>(_size));
+    ::close(_fd);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+
+#if !defined BOOST_WINDOWS_API
+boost::int64_t modification_time(const struct stat &st) {
+#if defined __APPLE__
+    const struct timespec &t = st.st_mtimespec;
+#else
+    const struct timespec &t = st.st_mtim;
+#endif
+    return static_cast<boost::int64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Maps a whole file in memory.
+ *
+ *	@param	const std::string& path The file to map.
+ *	@param	boost::uint64_t& size Receives the size of the file.
+ *	@param	bool& opened Set to true if the file could be opened at all.
+ *	@param	bool random_access Whether read-ahead should be disabled on the mapping.
+ *	@param	int& descriptor Receives the descriptor of the mapped file (POSIX only).
+ *	@param	boost::int64_t& mtime Receives the modification time of the mapped file.
+ *
+ *	@return	The address of the mapping, or nullptr if the file could not be mapped.
+ */
+void *map_file(const std::string &path, boost::uint64_t &size, bool &opened,
+               bool random_access, int &descriptor, boost::int64_t &mtime) {
+    void *address = nullptr;
+    size = 0;
+#if defined BOOST_WINDOWS_API
+    HANDLE f = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING,
+                             random_access ? FILE_FLAG_RANDOM_ACCESS
+                                           : FILE_ATTRIBUTE_NORMAL,
+                             nullptr);
+    opened = (f != INVALID_HANDLE_VALUE);
+    if (!opened) {
+        return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    if (::GetFileSizeEx(f, &file_size) && file_size.QuadPart > 0 &&
+        static_cast<boost::uint64_t>(file_size.QuadPart) <= SIZE_MAX) {
+        HANDLE mapping = ::CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            address = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            ::CloseHandle(mapping); // The view keeps the mapping alive.
+        }
+        if (address != nullptr) {
+            size = file_size.QuadPart;
+        }
+    }
+    ::CloseHandle(f);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    opened = (fd != -1);
+    if (!opened) {
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+        static_cast<boost::uint64_t>(st.st_size) <= SIZE_MAX) {
+        address = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                         MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            address = nullptr;
+        } else {
+            size = st.st_size;
+            mtime = modification_time(st);
+            if (random_access) { // Failure is harmless: this is only a hint.
+                ::madvise(address, static_cast<size_t>(size), MADV_RANDOM);
+            }
+        }
+    }
+    if (address != nullptr) {
+        // Kept so that the system can copy from the same file later (see file_writer.h).
+        descriptor = fd;
+    } else {
+        ::close(fd);
+    }
+#endif
+    return address;
+}
+
+} // !namespace
+
+// ----------------------------------------------------------------------------
+
+boost::shared_ptr<FileBuffer> FileBuffer::open(const std::string &path,
+                                               bool random_access) {
+    boost::shared_ptr<FileBuffer> res(new FileBuffer());
+
+    bool opened = false;
+    res->_mapped_address =
+        map_file(path, res->_size, opened, random_access, res->_fd, res->_mtime);
+    if (!opened) {
+        return boost::shared_ptr<FileBuffer>();
+    }
+    res->_path = path;
+    if (res->_mapped_address != nullptr) {
+        res->_data = static_cast<const boost::uint8_t *>(res->_mapped_address);
+        return res;
+    }
+
+    // The file could not be mapped. Fall back to reading it in memory.
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return boost::shared_ptr<FileBuffer>();
+    }
+    boost::uint8_t chunk[0x1000];
+    size_t read_bytes;
+    try {
+        while ((read_bytes = fread(chunk, 1, sizeof(chunk), f)) != 0) {
+            res->_contents.insert(res->_contents.end(), chunk, chunk + read_bytes);
+        }
+    } catch (const std::exception &e) {
+        PRINT_ERROR << "Failed to load " << path << " in memory! (" << e.what() << ")"
+                    << DEBUG_INFO << std::endl;
+        fclose(f);
+        return boost::shared_ptr<FileBuffer>();
+    }
+    fclose(f);
+
+    res->_size = res->_contents.size();
+    res->_data = res->_contents.empty() ? nullptr : &res->_contents[0];
+    return res;
+}
+
+// ----------------------------------------------------------------------------
+
+boost::shared_ptr<FileBuffer> FileBuffer::from_memory(shared_bytes bytes) {
+    if (bytes == nullptr) {
+        return boost::shared_ptr<FileBuffer>();
+    }
+    boost::shared_ptr<FileBuffer> res(new FileBuffer());
+    res->_size = bytes->size();
+    res->_data = bytes->empty() ? nullptr : &(*bytes)[0];
+    res->_owner = std::move(bytes);
+    return res;
+}
+
+// ----------------------------------------------------------------------------
+
+boost::shared_ptr<FileBuffer> FileBuffer::from_memory(const boost::uint8_t *data,
+                                                      boost::uint64_t size) {
+    if (data == nullptr) {
+        return boost::shared_ptr<FileBuffer>();
+    }
+    boost::shared_ptr<FileBuffer> res(new FileBuffer());
+    res->_data = data;
+    res->_size = size;
+    return res;
+}
+
+// ----------------------------------------------------------------------------
+
+int FileBuffer::get_descriptor() const {
+#if defined BOOST_WINDOWS_API
+    return -1;
+#else
+    struct stat st;
+    if (_fd == -1 || ::fstat(_fd, &st) != 0 ||
+        static_cast<boost::uint64_t>(st.st_size) != _size ||
+        modification_time(st) != _mtime) {
+        return -1;
+    }
+    return _fd;
+#endif
+}
+
+} // namespace mana::pe
@@ -0,0 +1,236 @@
+/*
+    This file is part of Manalyze.
+
+    Manalyze is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Manalyze is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <exception>
+
+#include <boost/system/api_config.hpp>
+
+#if defined BOOST_POSIX_API
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
+#include "manacommons/color.h"
+#include "manape/file_writer.h"
+
+namespace mana::pe {
+
+namespace {
+
+// Below this size, a system call to reach the source file costs more than copying the
+// bytes from the mapping.
+const size_t KERNEL_COPY_THRESHOLD = 64 * 1024;
+
+#if defined BOOST_POSIX_API
+
+/**
+ *	@brief	Writes a buffer to a file descriptor, retrying after partial writes.
+ *
+ *	@return	Whether all the bytes were written.
+ */
+bool write_all(int fd, const boost::uint8_t *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Asks the kernel to append a region of a file to a file descriptor.
+ *
+ *	@param	int source The file to copy from.
+ *	@param	boost::uint64_t offset The offset of the region in the source.
+ *	@param	boost::uint64_t size The size of the region.
+ *	@param	int destination The file to write into, at its current position.
+ *
+ *	@return	The number of bytes copied. It is smaller than size if the system does not
+ *			support copying between these files, in which case the caller has to write
+ *			the remaining bytes itself.
+ */
+boost::uint64_t kernel_copy(int source, boost::uint64_t offset, boost::uint64_t size,
+                            int destination) {
+    boost::uint64_t copied = 0;
+#if defined __linux__
+    bool use_copy_file_range = true;
+    while (copied < size) {
+        size_t chunk =
+            static_cast<size_t>(std::min<boost::uint64_t>(size - copied, 1 << 30));
+        ssize_t res;
+        if (use_copy_file_range) {
+            loff_t position = static_cast<loff_t>(offset + copied);
+            res = ::copy_file_range(source, &position, destination, nullptr, chunk, 0);
+            if (res < 0 && errno != EINTR) { // i.e. ENOSYS, or EXDEV on older kernels.
+                use_copy_file_range = false;
+                continue;
+            }
+        } else {
+            off_t position = static_cast<off_t>(offset + copied);
+            res = ::sendfile(destination, source, &position, chunk);
+            if (res < 0 && errno != EINTR) {
+                break;
+            }
+        }
+        if (res == 0) { // The file has been truncated.
+            break;
+        }
+        if (res > 0) {
+            copied += static_cast<boost::uint64_t>(res);
+        }
+    }
+#endif
+    return copied;
+}
+
+#endif // BOOST_POSIX_API
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+bool write_to_file(const boost::filesystem::path &destination,
+                   const std::vector<ByteView> &views, bool append) {
+    bool success = true;
+#if defined BOOST_POSIX_API
+    int out = ::open(destination.string().c_str(),
+                     O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    if (out == -1) {
+        PRINT_ERROR << "Could not open " << destination.string() << "." << DEBUG_INFO
+                    << std::endl;
+        return false;
+    }
+
+    for (auto it = views.begin(); success && it != views.end(); ++it) {
+        boost::uint64_t copied = 0;
+        if (it->size() >= KERNEL_COPY_THRESHOLD && it->get_file() != nullptr) {
+            // The descriptor is -1 if the file changed after it was mapped: the bytes
+            // are then written from the mapping, which still holds what was analyzed.
+            int fd = it->get_file()->get_descriptor();
+            if (fd != -1) {
+                copied = kernel_copy(fd, it->get_offset(), it->size(), out);
+            }
+        }
+        success = write_all(out, it->data() + copied, it->size() - copied);
+    }
+    success &= (::close(out) == 0);
+#else
+    FILE *out = fopen(destination.string().c_str(), append ? "ab" : "wb");
+    if (out == nullptr) {
+        PRINT_ERROR << "Could not open " << destination.string() << "." << DEBUG_INFO
+                    << std::endl;
+        return false;
+    }
+    for (auto it = views.begin(); success && it != views.end(); ++it) {
+        success = it->empty() || it->size() == fwrite(it->data(), 1, it->size(), out);
+    }
+    success &= (fclose(out) == 0);
+#endif
+
+    if (!success) {
+        PRINT_ERROR << "Could not write all the bytes for " << destination.string() << "."
+                    << DEBUG_INFO << std::endl;
+    }
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+
+BackgroundWriter::BackgroundWriter(size_t max_pending)
+    : _max_pending(std::max<size_t>(max_pending, 1)), _busy(false), _stopping(false),
+      _success(true), _thread(&BackgroundWriter::_run, this) {}
+
+// ----------------------------------------------------------------------------
+
+BackgroundWriter::~BackgroundWriter() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _job_available.notify_one();
+    _thread.join();
+}
+
+// ----------------------------------------------------------------------------
+
+void BackgroundWriter::submit(job j) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _slot_available.wait(lock, [this]() { return _jobs.size() < _max_pending; });
+    _jobs.push_back(std::move(j));
+    lock.unlock();
+    _job_available.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+
+bool BackgroundWriter::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]() { return _jobs.empty() && !_busy; });
+    bool res = _success;
+    _success = true;
+    return res;
+}
+
+// ----------------------------------------------------------------------------
+
+void BackgroundWriter::_run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _job_available.wait(lock, [this]() { return !_jobs.empty() || _stopping; });
+        if (_jobs.empty()) { // Stopping, and every job has been executed.
+            return;
+        }
+        job j = std::move(_jobs.front());
+        _jobs.pop_front();
+        _busy = true;
+        lock.unlock();
+        _slot_available.notify_one();
+
+        bool res = false;
+        try {
+            res = j();
+        } catch (const std::exception &e) {
+            PRINT_ERROR << "A background write failed: " << e.what() << DEBUG_INFO
+                        << std::endl;
+        }
+
+        lock.lock();
+        _busy = false;
+        _success &= res;
+        if (_jobs.empty()) {
+            _idle.notify_all();
+        }
+    }
+}
+
+} // namespace mana::pe
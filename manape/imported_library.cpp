@@ -24,7 +24,8 @@ ImportedLibrary::ImportedLibrary(const std::string& library_name, pimage_import_
 	: _image_import_descriptor(std::move(image_import_descriptor)),
 	  _load_type(ImportedLibrary::STANDARD), 
 	  _library_name(library_name),
-	  _imported_functions(new std::vector<pimport_lookup_table>())
+	  _imported_functions(new std::vector<pimport_lookup_table>()),
+	  _ordinals(nt::find_ordinal_table(library_name))
 {}
 
 // ----------------------------------------------------------------------------
@@ -33,9 +34,20 @@ ImportedLibrary::ImportedLibrary(const std::string& library_name)
 	: _image_import_descriptor(nullptr),
 	  _load_type(DELAY_LOADED),
 	  _library_name(library_name),
-	_imported_functions(new std::vector<pimport_lookup_table>())
+	_imported_functions(new std::vector<pimport_lookup_table>()),
+	  _ordinals(nt::find_ordinal_table(library_name))
 {}
 
 // ----------------------------------------------------------------------------
 
+std::string ImportedLibrary::get_function_name(const import_lookup_table& import) const
+{
+	if (!import.Name.empty()) {
+		return import.Name;
+	}
+	return nt::translate_ordinal(import.AddressOfData & 0x7FFF, _ordinals);
+}
+
+// ----------------------------------------------------------------------------
+
 } // !namespace mana
\ No newline at end of file
@@ -15,124 +15,171 @@
     along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <unordered_set>
+
 #include "manape/pe.h"
 
 namespace mana::pe {
 
-// ----------------------------------------------------------------------------
-
-bool PE::_parse_hint_name_table(pimport_lookup_table import) const {
-    int size_to_read = (get_architecture() == PE::x86 ? 4 : 8);
-
-    // Read the HINT/NAME TABLE if applicable. Check the most significant byte of
-    // AddressOfData to see if the import is by name or ordinal. For PE32+, AddressOfData
-    // is a uint64.
-    boost::uint64_t mask = (size_to_read == 8 ? 0x8000'0000'0000'0000 : 0x8000'0000);
-    if (!(import->AddressOfData & mask)) {
-        // Import by name. Read the HINT/NAME table. For both PE32 and PE32+, its RVA is
-        // stored in bits 30-0 of AddressOfData.
-        unsigned int table_offset = rva_to_offset(import->AddressOfData & 0x7FFF'FFFF);
-        if (table_offset == 0) {
-            PRINT_ERROR << "Could not reach the HINT/NAME table." << std::endl;
-            return false;
+namespace {
+
+// Past this number of entries, an IMPORT_LOOKUP_TABLE was almost certainly crafted
+// manually and the parsing stops.
+const size_t MAX_IMPORTS = 10000;
+
+/**
+ *	@brief	Counts the entries of an IMPORT_LOOKUP_TABLE by scanning the mapped entries
+ *			for the NULL terminator, without copying them.
+ *
+ *	@param	const FileCursor& cursor A cursor located at the start of the table.
+ *	@param	unsigned int entry_size The size of an entry (4 for PE32, 8 for PE32+).
+ *	@param	size_t max_entries The number of entries after which the search stops.
+ *	@param	bool& terminated Set to true if the NULL entry ending the table was found.
+ *
+ *	@return	The number of non-NULL entries.
+ */
+size_t count_thunks(const FileCursor &cursor, unsigned int entry_size, size_t max_entries,
+                    bool &terminated) {
+    static const boost::uint8_t null_entry[8] = {0};
+    const boost::uint8_t *data = cursor.data();
+    size_t available = static_cast<size_t>(
+        std::min<boost::uint64_t>(cursor.remaining() / entry_size, max_entries));
+    for (size_t i = 0; i < available; ++i) {
+        if (!memcmp(data + i * entry_size, null_entry, entry_size)) {
+            terminated = true;
+            return i;
         }
+    }
+    terminated = false;
+    return available;
+}
 
-        long saved_offset = ftell(_file_handle.get());
-        if (saved_offset == -1 || fseek(_file_handle.get(), table_offset, SEEK_SET) ||
-            2 != fread(&(import->Hint), 1, 2, _file_handle.get())) {
-            PRINT_ERROR << "Could not read a HINT/NAME hint." << std::endl;
-            return false;
-        }
-        import->Name = utils::read_ascii_string(_file_handle.get());
+} // namespace
 
-        // TODO: Demangle the import name
+// ----------------------------------------------------------------------------
 
-        // Go back to the import lookup table.
-        if (fseek(_file_handle.get(), saved_offset, SEEK_SET)) {
-            return false;
-        }
+bool PE::_parse_hint_name_table(const FileCursor &cursor,
+                                pimport_lookup_table import) const {
+    // For both PE32 and PE32+, the RVA of the HINT/NAME table is stored in bits 30-0 of
+    // AddressOfData.
+    unsigned int table_offset = rva_to_offset(import->AddressOfData & 0x7FFF'FFFF);
+    if (table_offset == 0) {
+        PRINT_ERROR << "Could not reach the HINT/NAME table." << std::endl;
+        return false;
+    }
+
+    FileCursor hint_name = cursor.at(table_offset);
+    if (!hint_name.read_le(import->Hint)) {
+        PRINT_ERROR << "Could not read a HINT/NAME hint." << std::endl;
+        return false;
     }
+    import->Name = utils::read_ascii_string(hint_name);
+
+    // TODO: Demangle the import name
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
 bool PE::_parse_import_lookup_table(unsigned int offset, pImportedLibrary library) const {
-    if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+    FileCursor cursor(_file);
+    if (!offset || !cursor.seek(offset)) {
         PRINT_ERROR << "Could not reach an IMPORT_LOOKUP_TABLE." << std::endl;
         return false;
     }
 
-    auto imports = library->get_imports();
-    while (true) // We stop at the first NULL IMPORT_LOOKUP_TABLE
-    {
-        pimport_lookup_table import = boost::make_shared<import_lookup_table>();
-        import->AddressOfData = 0;
-        import->Hint = 0;
-
-        // The field has a size of 8 for x64 PEs
-        unsigned int size_to_read = (get_architecture() == x86 ? 4 : 8);
-        if (size_to_read !=
-            fread(&(import->AddressOfData), 1, size_to_read, _file_handle.get())) {
-            PRINT_ERROR << "Could not read the IMPORT_LOOKUP_TABLE." << std::endl;
-            return false;
-        }
-
-        // Exit condition
-        if (import->AddressOfData == 0) {
-            break;
-        }
-
-        if (!_parse_hint_name_table(import)) {
-            return false;
-        }
+    // The entries have a size of 8 for x64 PEs. Their most significant bit tells whether
+    // the function is imported by ordinal or by name.
+    const bool pe32_plus = (get_architecture() == x64);
+    const unsigned int entry_size = (pe32_plus ? 8 : 4);
+    const boost::uint64_t ordinal_flag =
+        (pe32_plus ? 0x8000'0000'0000'0000 : 0x8000'0000);
+
+    // Find the NULL entry which ends the table, then read all the entries at once.
+    bool terminated = false;
+    size_t count = count_thunks(cursor, entry_size, MAX_IMPORTS + 1, terminated);
+    if (!_budget.check_entries(count, "import table")) {
+        count = static_cast<size_t>(_budget.allowed_entries(count, "import table"));
+        terminated = true; // Not an error: the truncation has been recorded.
+    }
+    if (!_budget.consume(count * entry_size, "import table")) {
+        return true;
+    }
+    std::vector<boost::uint64_t> thunks;
+    if (pe32_plus) {
+        cursor.read_array(thunks, count);
+    } else {
+        std::vector<boost::uint32_t> thunks32;
+        cursor.read_array(thunks32, count);
+        thunks.assign(thunks32.begin(), thunks32.end());
+    }
 
-        // Verify that the number of imports is sane:
-        if (imports->size() > 10000) {
+    // The Hint and Name of an import are entirely determined by its AddressOfData, so
+    // reading the same AddressOfData twice means that the table loops.
+    std::unordered_set<boost::uint64_t> seen;
+    seen.reserve(thunks.size());
+    library->get_imports()->reserve(thunks.size());
+    for (size_t i = 0; i < thunks.size(); ++i) {
+        if (i == MAX_IMPORTS) {
             PRINT_ERROR << "Gave up on parsing the import table after reading 10000 "
                            "entries! This PE was almost certainly crafted manually!"
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
         }
 
-        // Verify that the import is not already in the list (avoid parsing loops)
-        auto found = std::find_if(imports->begin(), imports->end(),
-                                  [import](const pimport_lookup_table &it) -> bool {
-                                      return import->AddressOfData == it->AddressOfData &&
-                                             import->Hint == it->Hint &&
-                                             import->Name == it->Name;
-                                  });
-
-        if (found != imports->end()) {
+        if (!seen.insert(thunks[i]).second) {
             PRINT_ERROR << "Read the same import twice! This PE was almost certainly "
                            "crafted manually!"
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
         }
 
+        pimport_lookup_table import = make_in_arena<import_lookup_table>(_arena);
+        import->AddressOfData = thunks[i];
+        import->Hint = 0;
+
+        // Import by name: read the HINT/NAME table.
+        if (!(import->AddressOfData & ordinal_flag)) {
+            if (!_parse_hint_name_table(cursor, import)) {
+                return false;
+            }
+            if (!_budget.consume(sizeof(import->Hint) + import->Name.size() + 1,
+                                 "import table")) {
+                return true;
+            }
+        }
         library->add_import(import);
     }
+
+    if (!terminated) {
+        PRINT_ERROR << "Could not read the IMPORT_LOOKUP_TABLE." << std::endl;
+        return false;
+    }
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_imports() {
-    if (!_ioh ||
-        _file_handle == nullptr) { // Image Optional Header wasn't parsed successfully.
+bool PE::_parse_imports() const {
+    if (!_ioh || _file == nullptr) { // Image Optional Header wasn't parsed successfully.
         return false;
     }
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_IMPORT)) { // No imports
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_IMPORT, cursor)) { // No imports
         return true;
     }
 
     while (true) // We stop at the first NULL IMAGE_IMPORT_DESCRIPTOR.
     {
+        if (!_budget.check_entries(_imports->size() + 1, "import table") ||
+            !_budget.consume(20, "import table")) {
+            break;
+        }
         pimage_import_descriptor iid(new image_import_descriptor);
         memset(iid.get(), 0,
                5 * sizeof(boost::uint32_t)); // Don't overwrite the last member (a string)
 
-        if (20 != fread(iid.get(), 1, 20, _file_handle.get())) {
+        if (20 != cursor.read(iid.get(), 20)) {
             PRINT_ERROR << "Could not read the IMAGE_IMPORT_DESCRIPTOR." << std::endl;
             return true; // Don't give up on the rest of the parsing.
         }
@@ -149,9 +196,9 @@ bool PE::_parse_imports() {
             offset = iid->Name;
         }
         std::string library_name;
-        if (!utils::read_string_at_offset(_file_handle.get(), offset, library_name)) {
+        if (!utils::read_string_at_offset(cursor, offset, library_name)) {
             // It seems that the Windows loader doesn't give up if such a thing happens.
-            if (_imports.size() > 0) {
+            if (_imports->size() > 0) {
                 PRINT_WARNING << "Could not read an import's name." << std::endl;
                 break; // Try to continue the parsing with the available imports.
             }
@@ -160,13 +207,14 @@ bool PE::_parse_imports() {
             return true;
         }
 
-        pImportedLibrary library =
-            pImportedLibrary(new ImportedLibrary(library_name, iid));
-        _imports.push_back(library);
+        // Not allocated in the arena: it holds pointers to the imports, which would
+        // keep the arena alive forever.
+        pImportedLibrary library(new ImportedLibrary(library_name, iid));
+        _imports->push_back(library);
     }
 
     // Parse the IMPORT_LOOKUP_TABLE for each imported library
-    for (auto it = _imports.begin(); it != _imports.end(); ++it) {
+    for (auto it = _imports->begin(); it != _imports->end(); ++it) {
         int ilt_offset;
         auto descriptor = (*it)->get_image_import_descriptor();
         if (descriptor == nullptr) {
@@ -203,18 +251,19 @@ bool PE::_parse_imports() {
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_delayed_imports() {
-    if (!_ioh ||
-        _file_handle == nullptr) { // Image Optional Header wasn't parsed successfully.
+bool PE::_parse_delayed_imports() const {
+    if (!_ioh || _file == nullptr) { // Image Optional Header wasn't parsed successfully.
         return false;
     }
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT)) { // No delayed imports
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT,
+                          cursor)) { // No delayed imports
         return true;
     }
 
     delay_load_directory_table dldt;
     memset(&dldt, 0, 8 * sizeof(boost::uint32_t));
-    if (1 != fread(&dldt, 8 * sizeof(boost::uint32_t), 1, _file_handle.get())) {
+    if (8 * sizeof(boost::uint32_t) != cursor.read(&dldt, 8 * sizeof(boost::uint32_t))) {
         PRINT_WARNING << "Could not read the Delay-Load Directory Table!" << std::endl;
         return true;
     }
@@ -228,30 +277,44 @@ bool PE::_parse_delayed_imports() {
 
     // Read the delayed DLL's name
     std::string name;
-    utils::read_string_at_offset(_file_handle.get(), offset, name);
+    utils::read_string_at_offset(cursor, offset, name);
     pImportedLibrary library(new ImportedLibrary(name));
 
     dldt.NameStr = name;
-    _delay_load_directory_table.reset(dldt);
+    _delay_load_directory_table = boost::make_shared<delay_load_directory_table>(dldt);
 
     // Read the imports
     offset = rva_to_offset(dldt.DelayImportNameTable);
 
     if (_parse_import_lookup_table(offset, library)) {
-        _imports.push_back(library);
+        _imports->push_back(library);
     }
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
+void PE::_ensure_imports_parsed() const {
+    if (_headers_only) {
+        return;
+    }
+    std::call_once(_imports_parsed, [this]() {
+        ParseBudget::Timer timer(_budget);
+        _parse_imports();
+        _parse_delayed_imports();
+    });
+}
+
+// ----------------------------------------------------------------------------
+
 const_shared_strings PE::get_imported_dlls() const {
     auto destination = boost::make_shared<std::vector<std::string>>();
     if (!_initialized) {
         return destination;
     }
+    _ensure_imports_parsed();
 
-    for (auto it = _imports.begin(); it != _imports.end(); ++it) {
+    for (auto it = _imports->begin(); it != _imports->end(); ++it) {
         pString s = (*it)->get_name();
         if (s != nullptr) {
             destination->push_back(*s);
@@ -267,14 +330,15 @@ const_shared_strings PE::get_imported_functions(const std::string &dll) const {
     if (!_initialized) {
         return destination;
     }
+    _ensure_imports_parsed();
 
     // We don't want to use PE::_find_imported_dlls: no regexp matching is necessary,
     // since we only look for a simple exact name here.
-    auto found = std::find_if(_imports.begin(), _imports.end(),
+    auto found = std::find_if(_imports->begin(), _imports->end(),
                               [dll](const pImportedLibrary &l) -> bool {
                                   return l->get_name() && *l->get_name() == dll;
                               });
-    if (found == _imports.end() || !*found) {
+    if (found == _imports->end() || !*found) {
         return destination;
     }
     auto library = *found;
@@ -284,12 +348,7 @@ const_shared_strings PE::get_imported_functions(const std::string &dll) const {
         return destination;
     }
     for (const auto &it : *functions) {
-        if (it->Name != "") {
-            destination->push_back(it->Name);
-        } else {
-            boost::uint16_t ordinal = it->AddressOfData & 0x7FFF;
-            destination->push_back(*nt::translate_ordinal(ordinal, dll));
-        }
+        destination->push_back(library->get_function_name(*it));
     }
 
     return destination;
@@ -303,6 +362,7 @@ shared_imports PE::find_imported_dlls(const std::string &name_regexp,
     if (!_initialized) {
         return boost::make_shared<const std::vector<pImportedLibrary>>(destination);
     }
+    _ensure_imports_parsed();
 
     boost::regex e;
     if (case_sensitivity) {
@@ -311,7 +371,7 @@ shared_imports PE::find_imported_dlls(const std::string &name_regexp,
         e = boost::regex(name_regexp, boost::regex::icase);
     }
 
-    for (auto it = _imports.begin(); it != _imports.end(); ++it) {
+    for (auto it = _imports->begin(); it != _imports->end(); ++it) {
         pString name = (*it)->get_name();
         if (name != nullptr && boost::regex_match(*name, e)) {
             destination.push_back(*it);
@@ -350,13 +410,7 @@ const_shared_strings PE::find_imports(const std::string &function_name_regexp,
         }
         // Iterate on functions imported by each of these DLLs
         for (const auto &it2 : *imported_functions) {
-            std::string name;
-            if (it2->Name == "") {
-                name =
-                    *nt::translate_ordinal(it2->AddressOfData & 0x7FFF, *it->get_name());
-            } else {
-                name = it2->Name;
-            }
+            std::string name = it->get_function_name(*it2);
             // Functions may be imported multiple times, don't add the same one twice.
             if (boost::regex_match(name, e) &&
                 std::find(destination->begin(), destination->end(), name) ==
@@ -0,0 +1,127 @@
+/*
+    This file is part of Manalyze.
+
+    Manalyze is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Manalyze is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "manacommons/color.h"
+#include "manape/parse_budget.h"
+
+namespace mana::pe {
+
+ParseBudget::ParseBudget(const parse_limits &limits)
+    : _limits(limits), _parse_time(0), _running_timers(0), _bytes(0),
+      _reasons(truncation::NONE) {}
+
+// ----------------------------------------------------------------------------
+
+ParseBudget::Timer::Timer(ParseBudget &budget) : _budget(budget) {
+    if (_budget._limits.max_duration == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_budget._lock);
+    if (_budget._running_timers++ == 0) {
+        _budget._start = std::chrono::steady_clock::now();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+ParseBudget::Timer::~Timer() {
+    if (_budget._limits.max_duration == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_budget._lock);
+    if (--_budget._running_timers == 0) {
+        _budget._parse_time += std::chrono::steady_clock::now() - _budget._start;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool ParseBudget::consume(boost::uint64_t bytes, const char *directory) {
+    if (_reasons & (truncation::BYTES | truncation::DEADLINE)) {
+        _truncate(_reasons & truncation::BYTES ? truncation::BYTES : truncation::DEADLINE,
+                  directory);
+        return false;
+    }
+
+    if (_limits.max_bytes != 0 && (_bytes += bytes) > _limits.max_bytes) {
+        _truncate(truncation::BYTES, directory);
+        return false;
+    }
+    if (_limits.max_duration != 0 &&
+        _elapsed() > std::chrono::milliseconds(_limits.max_duration)) {
+        _truncate(truncation::DEADLINE, directory);
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+boost::uint64_t ParseBudget::allowed_entries(boost::uint64_t count,
+                                             const char *directory) {
+    if (_limits.max_entries == 0 || count <= _limits.max_entries) {
+        return count;
+    }
+    _truncate(truncation::ENTRIES, directory);
+    return _limits.max_entries;
+}
+
+// ----------------------------------------------------------------------------
+
+truncation ParseBudget::get_truncation() const {
+    truncation res;
+    std::lock_guard<std::mutex> lock(_lock);
+    res.reasons = _reasons;
+    res.directories = _directories;
+    return res;
+}
+
+// ----------------------------------------------------------------------------
+
+std::chrono::steady_clock::duration ParseBudget::_elapsed() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_running_timers == 0) {
+        return _parse_time;
+    }
+    return _parse_time + (std::chrono::steady_clock::now() - _start);
+}
+
+// ----------------------------------------------------------------------------
+
+void ParseBudget::_truncate(truncation::reason reason, const char *directory) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _reasons |= reason;
+    if (!_directories.insert(directory).second) {
+        return; // Only warn once per directory.
+    }
+
+    PRINT_WARNING << "Stopped parsing the " << directory << " because ";
+    switch (reason) {
+    case truncation::BYTES:
+        std::cerr << "too much data was read from the file.";
+        break;
+    case truncation::ENTRIES:
+        std::cerr << "it contains more than " << _limits.max_entries << " entries.";
+        break;
+    default:
+        std::cerr << "the parsing took more than " << _limits.max_duration << "ms.";
+        break;
+    }
+    std::cerr << " The analysis will be incomplete." << std::endl;
+}
+
+} // namespace mana::pe
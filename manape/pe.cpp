@@ -19,18 +19,31 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace mana::pe {
 
-PE::PE(const std::string &path) : _path(path), _initialized(false) {
-    FILE *f = fopen(_path.c_str(), "rb");
-    if (f == nullptr) {
+PE::PE(const std::string &path, parse_mode mode, const parse_limits &limits)
+    : PE(FileBuffer::open(path, mode == HEADERS_ONLY), path, mode, limits) {
+    if (_file == nullptr) {
         PRINT_ERROR << "Could not open " << _path << "." << std::endl;
-        return;
     }
-    _file_handle = boost::shared_ptr<FILE>(f, fclose);
+}
 
-    // Get the file size
-    fseek(_file_handle.get(), 0, SEEK_END);
-    _file_size = ftell(_file_handle.get());
-    fseek(_file_handle.get(), 0, SEEK_SET);
+// ----------------------------------------------------------------------------
+
+PE::PE(pFileBuffer file, const std::string &name, parse_mode mode,
+       const parse_limits &limits)
+    : _path(name), _initialized(false), _headers_only(mode == HEADERS_ONLY),
+      _file_size(0), _file(std::move(file)), _arena(boost::make_shared<Arena>(limits.use_arena)),
+      _budget(limits), _sections(boost::make_shared<std::vector<pSection>>()),
+      _imports(boost::make_shared<std::vector<pImportedLibrary>>()),
+      _exports(boost::make_shared<std::vector<pexported_function>>()),
+      _resource_table(boost::make_shared<std::vector<pResource>>()),
+      _debug_entries(boost::make_shared<std::vector<pdebug_directory_entry>>()),
+      _relocation_table(boost::make_shared<RelocationTable>()),
+      _certificates(boost::make_shared<std::vector<pwin_certificate>>()) {
+    if (_file == nullptr) {
+        return;
+    }
+    _file_size = _file->size();
+    ParseBudget::Timer timer(_budget);
 
     if (!_parse_dos_header()) {
         return;
@@ -44,20 +57,50 @@ PE::PE(const std::string &path) : _path(path), _initialized(false) {
         return;
     }
 
+    // Section names may be stored in the COFF string table, so it has to be located
+    // first. Executables without one are perfectly valid.
+    _parse_coff_string_table();
+
     if (!_parse_section_table()) {
         return;
     }
 
     // Failure is acceptable from here on.
     _initialized = true;
+    if (_headers_only) {
+        return;
+    }
     _parse_coff_symbols();
-    _parse_directories();
+    // Data directories are parsed on demand, by their respective getters.
+}
+
+// ----------------------------------------------------------------------------
+
+boost::shared_ptr<PE> PE::create(const std::string &path, parse_mode mode,
+                                 const parse_limits &limits) {
+    return boost::make_shared<PE>(path, mode, limits);
+}
+
+// ----------------------------------------------------------------------------
+
+boost::shared_ptr<PE> PE::from_memory(shared_bytes bytes, const std::string &name,
+                                      parse_mode mode, const parse_limits &limits) {
+    if (bytes == nullptr) {
+        PRINT_ERROR << "Tried to parse a PE from a NULL buffer." << std::endl;
+    }
+    return boost::make_shared<PE>(FileBuffer::from_memory(std::move(bytes)), name, mode,
+                                  limits);
 }
 
 // ----------------------------------------------------------------------------
 
-boost::shared_ptr<PE> PE::create(const std::string &path) {
-    return boost::make_shared<PE>(path);
+boost::shared_ptr<PE> PE::from_memory(const boost::uint8_t *data, size_t size,
+                                      const std::string &name, parse_mode mode,
+                                      const parse_limits &limits) {
+    if (data == nullptr) {
+        PRINT_ERROR << "Tried to parse a PE from a NULL buffer." << std::endl;
+    }
+    return boost::make_shared<PE>(FileBuffer::from_memory(data, size), name, mode, limits);
 }
 
 // ----------------------------------------------------------------------------
@@ -80,35 +123,61 @@ boost::uint64_t PE::get_filesize() const { return _file_size; }
 // ----------------------------------------------------------------------------
 
 PE::architecture PE::get_architecture() const {
-    return (_ioh->Magic == nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32+") ? PE::x64
-                                                                       : PE::x86);
+    return (_ioh->Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC ? PE::x64 : PE::x86);
 }
 
 // ----------------------------------------------------------------------------
 
 shared_bytes PE::get_raw_bytes(size_t size) const {
-    if (_file_handle == nullptr) {
+    if (_file == nullptr) {
         return nullptr;
     }
-    fseek(_file_handle.get(), 0, SEEK_SET);
-    if (size > _file_size) {
-        size = static_cast<size_t>(_file_size);
+    return get_raw_view(size).to_vector();
+}
+
+// ----------------------------------------------------------------------------
+
+ByteView PE::get_raw_view(size_t size) const { return ByteView(_file, 0, size); }
+
+// ----------------------------------------------------------------------------
+
+shared_relocations PE::get_relocations() const {
+    pRelocationTable table = get_relocation_table();
+    if (table == nullptr) {
+        return shared_relocations();
+    }
+
+    // The table is sorted by RVA, so the entries of each block are contiguous.
+    auto res = boost::make_shared<std::vector<pimage_base_relocation>>();
+    for (const relocation &r : *table) {
+        if (res->empty() || res->back()->PageRVA != r.PageRVA) {
+            auto block = boost::make_shared<image_base_relocation>();
+            block->PageRVA = r.PageRVA;
+            block->BlockSize = 2 * sizeof(boost::uint32_t);
+            res->push_back(block);
+        }
+        image_base_relocation &block = *res->back();
+        block.TypesOffsets.push_back(static_cast<boost::uint16_t>((r.Type << 12) | r.Offset));
+        block.BlockSize += sizeof(boost::uint16_t);
     }
-    auto res = boost::make_shared<std::vector<boost::uint8_t>>(size);
-    fread(&(*res)[0], 1, size, _file_handle.get());
     return res;
 }
 
 // ----------------------------------------------------------------------------
 
 shared_bytes PE::get_overlay_bytes(size_t size) const {
-    if (_file_handle == nullptr || !_ioh || size == 0) {
+    ByteView view = get_overlay_view(size);
+    if (view.empty()) {
         return nullptr;
     }
+    return view.to_vector();
+}
 
-    const auto sections = get_sections();
-    if (!sections) {
-        return nullptr;
+// ----------------------------------------------------------------------------
+
+ByteView PE::get_overlay_view(size_t size) const {
+    if (_file == nullptr || !_ioh || size == 0) {
+        return ByteView();
     }
 
     // Find where the overlay data would be located.
@@ -122,7 +191,7 @@ shared_bytes PE::get_overlay_bytes(size_t size) const {
             _ioh->directories[IMAGE_DIRECTORY_ENTRY_SECURITY].Size;
     } else // Otherwise, look after the last section.
     {
-        for (const auto &it : *sections) {
+        for (const auto &it : *_sections) {
             if (static_cast<uint64_t>(it->get_pointer_to_raw_data()) +
                     it->get_size_of_raw_data() >
                 max_offset) {
@@ -134,22 +203,15 @@ shared_bytes PE::get_overlay_bytes(size_t size) const {
 
     // The PE has no overlay data.
     if (max_offset >= get_filesize()) {
-        return nullptr;
-    }
-
-    fseek(_file_handle.get(), max_offset, SEEK_SET);
-    if (size > _file_size - max_offset) {
-        size = static_cast<size_t>(_file_size - max_offset);
+        return ByteView();
     }
-    auto res = boost::make_shared<std::vector<boost::uint8_t>>(size);
-    fread(&(*res)[0], 1, size, _file_handle.get());
-    return res;
+    return ByteView(_file, max_offset, size);
 }
 
 // ----------------------------------------------------------------------------
 
 bool PE::_parse_dos_header() {
-    if (_file_handle == nullptr) {
+    if (_file == nullptr) {
         return false;
     }
 
@@ -161,7 +223,7 @@ bool PE::_parse_dos_header() {
         return false;
     }
 
-    if (sizeof(dos) != fread(&dos, 1, sizeof(dos), _file_handle.get())) {
+    if (sizeof(dos) != _file->read(0, &dos, sizeof(dos))) {
         PRINT_ERROR << "Could not read the DOS Header." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return false;
@@ -178,19 +240,20 @@ bool PE::_parse_dos_header() {
 // ----------------------------------------------------------------------------
 
 bool PE::_parse_pe_header() {
-    if (!_h_dos || _file_handle == nullptr) {
+    if (!_h_dos || _file == nullptr) {
         return false;
     }
 
     pe_header peh;
     memset(&peh, 0, sizeof(peh));
 
-    if (fseek(_file_handle.get(), _h_dos->e_lfanew, SEEK_SET)) {
-        PRINT_ERROR << "Could not reach PE header (fseek to offset " << _h_dos->e_lfanew
+    FileCursor cursor(_file);
+    if (!cursor.seek(_h_dos->e_lfanew)) {
+        PRINT_ERROR << "Could not reach PE header (seek to offset " << _h_dos->e_lfanew
                     << " failed)." << DEBUG_INFO_INSIDEPE << std::endl;
         return false;
     }
-    if (sizeof(peh) != fread(&peh, 1, sizeof(peh), _file_handle.get())) {
+    if (sizeof(peh) != cursor.read(&peh, sizeof(peh))) {
         PRINT_ERROR << "Could not read the PE Header." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return false;
@@ -207,7 +270,7 @@ bool PE::_parse_pe_header() {
 // ----------------------------------------------------------------------------
 
 bool PE::_parse_coff_symbols() {
-    if (!_h_pe || _file_handle == nullptr) {
+    if (!_h_pe || _file == nullptr) {
         return false;
     }
 
@@ -215,42 +278,73 @@ bool PE::_parse_coff_symbols() {
         return true;
     }
 
-    if (fseek(_file_handle.get(), _h_pe->PointerToSymbolTable, SEEK_SET)) {
-        PRINT_ERROR << "Could not reach PE COFF symbols (fseek to offset "
+    FileCursor cursor(_file);
+    if (!cursor.seek(_h_pe->PointerToSymbolTable)) {
+        PRINT_ERROR << "Could not reach PE COFF symbols (seek to offset "
                     << _h_pe->PointerToSymbolTable << " failed)." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return false;
     }
 
-    for (unsigned int i = 0; i < _h_pe->NumberOfSymbols; ++i) {
-        pcoff_symbol sym = boost::make_shared<coff_symbol>();
-        memset(sym.get(), 0, sizeof(coff_symbol));
+    // The whole table is copied at once. Checking its size first ensures that nothing
+    // is allocated for an impossible number of symbols.
+    const boost::uint64_t size =
+        static_cast<boost::uint64_t>(_h_pe->NumberOfSymbols) * sizeof(coff_symbol);
+    if (size > cursor.remaining()) {
+        PRINT_ERROR << "Could not read the COFF symbols." << DEBUG_INFO_INSIDEPE
+                    << std::endl;
+        return false;
+    }
+    auto count = static_cast<size_t>(
+        _budget.allowed_entries(_h_pe->NumberOfSymbols, "COFF symbol table"));
+    if (!_budget.consume(count * sizeof(coff_symbol), "COFF symbol table")) {
+        return true;
+    }
+    ByteView symbols = cursor.view(count * sizeof(coff_symbol));
+    _coff_symbols.resize(count);
+    memcpy(&_coff_symbols[0], symbols.data(), symbols.size());
+
+    auto invalid =
+        std::remove_if(_coff_symbols.begin(), _coff_symbols.end(),
+                       [this](const coff_symbol &sym) {
+                           return sym.SectionNumber > _sections->size();
+                       });
+    if (invalid != _coff_symbols.end()) {
+        PRINT_WARNING << std::distance(invalid, _coff_symbols.end())
+                      << " COFF symbol(s) have a section number bigger than the number "
+                         "of sections!"
+                      << DEBUG_INFO_INSIDEPE << std::endl;
+        _coff_symbols.erase(invalid, _coff_symbols.end());
+    }
+    return true;
+}
 
-        if (18 != fread(sym.get(), 1, 18,
-                        _file_handle.get())) // Each symbol has a fixed size of 18 bytes.
-        {
-            PRINT_ERROR << "Could not read a COFF symbol." << DEBUG_INFO_INSIDEPE
-                        << std::endl;
-            return false;
-        }
+// ----------------------------------------------------------------------------
 
-        if (sym->SectionNumber > _sections.size()) {
-            PRINT_WARNING
-                << "COFF symbol's section number is bigger than the number of sections!"
-                << DEBUG_INFO_INSIDEPE << std::endl;
-            continue;
-        }
+bool PE::_parse_coff_string_table() {
+    if (!_h_pe || _file == nullptr) {
+        return false;
+    }
 
-        _coff_symbols.push_back(sym);
+    if (_h_pe->NumberOfSymbols == 0 || _h_pe->PointerToSymbolTable == 0) {
+        return true;
     }
 
-    // Read the COFF string table
-    size_t st_size = 0;
-    size_t count = 0;
-    fread(&st_size, 4, 1, _file_handle.get());
-    if (st_size >
-        get_filesize() - ftell(_file_handle.get())) // Weak error check, but I couldn't
-                                                    // find a better one in the PE spec.
+    // The string table is located right after the symbols. It starts with its own size,
+    // and the offsets pointing into it are relative to its beginning.
+    const boost::uint64_t offset =
+        _h_pe->PointerToSymbolTable +
+        static_cast<boost::uint64_t>(_h_pe->NumberOfSymbols) * sizeof(coff_symbol);
+    FileCursor cursor(_file);
+    boost::uint32_t st_size = 0;
+    if (!cursor.seek(offset) || !cursor.read_le(st_size)) {
+        PRINT_WARNING << "Could not reach the COFF String Table." << DEBUG_INFO_INSIDEPE
+                      << std::endl;
+        return false;
+    }
+    if (st_size > cursor.remaining() + sizeof(st_size)) // Weak error check, but I
+                                                        // couldn't find a better one in
+                                                        // the PE spec.
     {
         PRINT_WARNING
             << "COFF String Table's reported size is bigger than the remaining bytes!"
@@ -258,20 +352,14 @@ bool PE::_parse_coff_symbols() {
         return false;
     }
 
-    while (count < st_size) {
-        pString s =
-            boost::make_shared<std::string>(utils::read_ascii_string(_file_handle.get()));
-        _coff_string_table.push_back(s);
-        count += s->size() + 1; // Count the null terminator as well.
-    }
-
+    _coff_string_table = ByteView(_file, offset, st_size);
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
 bool PE::_parse_image_optional_header() {
-    if (!_h_pe || _file_handle == nullptr) {
+    if (!_h_pe || _file == nullptr) {
         return false;
     }
 
@@ -284,35 +372,35 @@ bool PE::_parse_image_optional_header() {
         return true;
     }
 
-    if (fseek(_file_handle.get(), _h_dos->e_lfanew + sizeof(pe_header), SEEK_SET)) {
-        PRINT_ERROR << "Could not reach the Image Optional Header (fseek to offset "
+    FileCursor cursor(_file);
+    if (!cursor.seek(_h_dos->e_lfanew + sizeof(pe_header))) {
+        PRINT_ERROR << "Could not reach the Image Optional Header (seek to offset "
                     << _h_dos->e_lfanew + sizeof(pe_header) << " failed)."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return false;
     }
 
     // Only read the first 0x18 bytes: after that, we have to fill the fields manually.
-    if (0x18 != fread(&ioh, 1, 0x18, _file_handle.get())) {
+    if (0x18 != cursor.read(&ioh, 0x18)) {
         PRINT_ERROR << "Could not read the Image Optional Header." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return false;
     }
 
-    if (ioh.Magic != nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32") &&
-        ioh.Magic != nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32+")) {
+    if (ioh.Magic != IMAGE_NT_OPTIONAL_HDR32_MAGIC &&
+        ioh.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
         PRINT_ERROR << "Invalid Image Optional Header magic." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return false;
-    } else if (ioh.Magic == nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32")) {
-        if (4 != fread(&ioh.BaseOfData, 1, 4, _file_handle.get()) ||
-            4 != fread(&ioh.ImageBase, 1, 4, _file_handle.get())) {
+    } else if (ioh.Magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC) {
+        if (!cursor.read_le(ioh.BaseOfData) || !cursor.read_le(ioh.ImageBase, 4)) {
             PRINT_ERROR << "Error reading the PE32 specific part of ImageOptionalHeader."
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
         }
     } else {
         // PE32+: BaseOfData doesn't exist, and ImageBase is a uint64.
-        if (8 != fread(&ioh.ImageBase, 1, 8, _file_handle.get())) {
+        if (!cursor.read_le(ioh.ImageBase)) {
             PRINT_ERROR << "Error reading the PE32+ specific part of ImageOptionalHeader."
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
@@ -320,7 +408,7 @@ bool PE::_parse_image_optional_header() {
     }
 
     // After this, PE32 and PE32+ structures are in sync for a while.
-    if (0x28 != fread(&ioh.SectionAlignment, 1, 0x28, _file_handle.get())) {
+    if (0x28 != cursor.read(&ioh.SectionAlignment, 0x28)) {
         PRINT_ERROR << "Error reading the common part of ImageOptionalHeader."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return false;
@@ -335,21 +423,20 @@ bool PE::_parse_image_optional_header() {
 
     // The next 4 values may be uint32s or uint64s depending on whether this is a PE32+
     // header. We store them in uint64s in any case.
-    if (ioh.Magic == nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32+")) {
-        if (40 != fread(&ioh.SizeofStackReserve, 1, 40, _file_handle.get())) {
+    if (ioh.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+        if (40 != cursor.read(&ioh.SizeofStackReserve, 40)) {
             PRINT_ERROR
                 << "Error reading SizeOfStackReserve for a PE32+ IMAGE OPTIONAL HEADER."
                 << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
         }
     } else {
-        fread(&ioh.SizeofStackReserve, 1, 4, _file_handle.get());
-        fread(&ioh.SizeofStackCommit, 1, 4, _file_handle.get());
-        fread(&ioh.SizeofHeapReserve, 1, 4, _file_handle.get());
-        fread(&ioh.SizeofHeapCommit, 1, 4, _file_handle.get());
-        fread(&ioh.LoaderFlags, 1, 4, _file_handle.get());
-        fread(&ioh.NumberOfRvaAndSizes, 1, 4, _file_handle.get());
-        if (feof(_file_handle.get()) || ferror(_file_handle.get())) {
+        if (!cursor.read_le(ioh.SizeofStackReserve, 4) ||
+            !cursor.read_le(ioh.SizeofStackCommit, 4) ||
+            !cursor.read_le(ioh.SizeofHeapReserve, 4) ||
+            !cursor.read_le(ioh.SizeofHeapCommit, 4) ||
+            !cursor.read_le(ioh.LoaderFlags) ||
+            !cursor.read_le(ioh.NumberOfRvaAndSizes)) {
             PRINT_ERROR
                 << "Error reading SizeOfStackReserve for a PE32 IMAGE OPTIONAL HEADER."
                 << DEBUG_INFO_INSIDEPE << std::endl;
@@ -369,7 +456,7 @@ bool PE::_parse_image_optional_header() {
 
     for (unsigned int i = 0;
          i < std::min(ioh.NumberOfRvaAndSizes, static_cast<boost::uint32_t>(0x10)); ++i) {
-        if (8 != fread(&ioh.directories[i], 1, 8, _file_handle.get())) {
+        if (8 != cursor.read(&ioh.directories[i], 8)) {
             PRINT_ERROR << "Could not read directory entry " << i << "."
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
@@ -383,14 +470,14 @@ bool PE::_parse_image_optional_header() {
 // ----------------------------------------------------------------------------
 
 bool PE::_parse_section_table() {
-    if (!_h_pe || !_h_dos || _file_handle == nullptr) {
+    if (!_h_pe || !_h_dos || _file == nullptr) {
         return false;
     }
 
-    if (fseek(_file_handle.get(),
-              _h_dos->e_lfanew + sizeof(pe_header) + _h_pe->SizeOfOptionalHeader,
-              SEEK_SET)) {
-        PRINT_ERROR << "Could not reach the Section Table (fseek to offset "
+    FileCursor cursor(_file);
+    if (!cursor.seek(_h_dos->e_lfanew + sizeof(pe_header) +
+                     _h_pe->SizeOfOptionalHeader)) {
+        PRINT_ERROR << "Could not reach the Section Table (seek to offset "
                     << _h_dos->e_lfanew + sizeof(pe_header) + _h_pe->SizeOfOptionalHeader
                     << " failed)." << DEBUG_INFO_INSIDEPE << std::endl;
         return false;
@@ -400,51 +487,55 @@ bool PE::_parse_section_table() {
         image_section_header sec;
         memset(&sec, 0, sizeof(image_section_header));
         if (sizeof(image_section_header) !=
-            fread(&sec, 1, sizeof(image_section_header), _file_handle.get())) {
+            cursor.read(&sec, sizeof(image_section_header))) {
             PRINT_ERROR << "Could not read section " << i << "." << DEBUG_INFO_INSIDEPE
                         << std::endl;
             return false;
         }
-        _sections.push_back(boost::make_shared<Section>(sec, _file_handle, _file_size,
-                                                        _coff_string_table));
+        _sections->push_back(
+            make_in_arena<Section>(_arena, sec, _file, _file_size, _coff_string_table));
     }
 
+    _section_index = boost::make_shared<SectionIndex>(*_sections);
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_debug() {
-    if (!_ioh || _file_handle == nullptr) {
+bool PE::_parse_debug() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_DEBUG)) { // No debug information.
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_DEBUG, cursor)) { // No debug information.
         return true;
     }
 
     unsigned int size = 6 * sizeof(boost::uint32_t) + 2 * sizeof(boost::uint16_t);
-    unsigned int number_of_entries =
-        _ioh->directories[IMAGE_DIRECTORY_ENTRY_DEBUG].Size / size;
+    auto number_of_entries = _budget.allowed_entries(
+        _ioh->directories[IMAGE_DIRECTORY_ENTRY_DEBUG].Size / size, "debug directory");
 
     for (unsigned int i = 0; i < number_of_entries; ++i) {
-        auto debug = boost::make_shared<debug_directory_entry>();
+        if (!_budget.consume(size, "debug directory")) {
+            break;
+        }
+        auto debug = make_in_arena<debug_directory_entry>(_arena);
         memset(debug.get(), 0, size);
-        if (size != fread(debug.get(), 1, size, _file_handle.get())) {
+        if (size != cursor.read(debug.get(), size)) {
             PRINT_ERROR << "Could not read the DEBUG_DIRECTORY_ENTRY"
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
         }
 
         // VC++ Debug information
-        if (debug->Type == nt::DEBUG_TYPES.at("IMAGE_DEBUG_TYPE_CODEVIEW")) {
+        if (debug->Type == IMAGE_DEBUG_TYPE_CODEVIEW) {
             pdb_info pdb;
             unsigned int pdb_size =
                 2 * sizeof(boost::uint32_t) + 16 * sizeof(boost::uint8_t);
             memset(&pdb, 0, pdb_size);
 
-            unsigned int saved_offset = ftell(_file_handle.get());
-            fseek(_file_handle.get(), debug->PointerToRawData, SEEK_SET);
-            if (pdb_size != fread(&pdb, 1, pdb_size, _file_handle.get()) ||
+            FileCursor pdb_cursor = cursor.at(debug->PointerToRawData);
+            if (pdb_size != pdb_cursor.read(&pdb, pdb_size) ||
                 (pdb.Signature != 0x5344'5352 &&
                  pdb.Signature != 0x3031'424E)) // Signature: "RSDS" or "NB10"
             {
@@ -454,36 +545,33 @@ bool PE::_parse_debug() {
                 return false;
             }
             pdb.PdbFileName = utils::read_ascii_string(
-                _file_handle.get()); // Not optimal, but it'll help if I decide to
-                                     // further parse these debug sub-structures.
+                pdb_cursor); // Not optimal, but it'll help if I decide to
+                             // further parse these debug sub-structures.
             debug->Filename = pdb.PdbFileName;
-            fseek(_file_handle.get(), saved_offset, SEEK_SET);
-        } else if (debug->Type == nt::DEBUG_TYPES.at("IMAGE_DEBUG_TYPE_MISC")) {
+        } else if (debug->Type == IMAGE_DEBUG_TYPE_MISC) {
             image_debug_misc misc;
             unsigned int misc_size =
                 2 * sizeof(boost::uint32_t) + 4 * sizeof(boost::uint8_t);
             memset(&misc, 1, misc_size);
-            unsigned int saved_offset = ftell(_file_handle.get());
-            fseek(_file_handle.get(), debug->PointerToRawData, SEEK_SET);
-            if (misc_size != fread(&misc, 1, misc_size, _file_handle.get())) {
+            FileCursor misc_cursor = cursor.at(debug->PointerToRawData);
+            if (misc_size != misc_cursor.read(&misc, misc_size)) {
                 PRINT_ERROR << "Could not read DBG file information"
                             << DEBUG_INFO_INSIDEPE << std::endl;
                 return false;
             }
             switch (misc.Unicode) {
             case 1:
-                misc.DbgFile = utils::read_unicode_string(_file_handle.get(),
-                                                          misc.Length - misc_size);
+                misc.DbgFile =
+                    utils::read_unicode_string(misc_cursor, misc.Length - misc_size);
                 break;
             case 0:
                 misc.DbgFile =
-                    utils::read_ascii_string(_file_handle.get(), misc.Length - misc_size);
+                    utils::read_ascii_string(misc_cursor, misc.Length - misc_size);
                 break;
             }
             debug->Filename = misc.DbgFile;
-            fseek(_file_handle.get(), saved_offset, SEEK_SET);
         }
-        _debug_entries.push_back(debug);
+        _debug_entries->push_back(debug);
     }
 
     return true;
@@ -501,33 +589,16 @@ unsigned int PE::rva_to_offset(boost::uint64_t rva) const {
     }
 
     // Special case: PE with no sections
-    if (_sections.empty()) {
+    if (_sections->empty()) {
         return rva & 0xFFFF'FFFF; // If the file is bigger than 4GB, this assumption may
                                   // not be true.
     }
 
-    // Find the corresponding section.
-    pSection section = pSection();
-    for (const auto &it : _sections) {
-        if (is_address_in_section(rva, it)) {
-            section = it;
-            break;
-        }
-    }
-
-    if (section == nullptr) {
-        // No section found. Maybe the VirsualSize is erroneous? Try with the
-        // RawSizeOfData.
-        for (const auto &it : _sections) {
-            if (is_address_in_section(rva, it, true)) {
-                section = it;
-                break;
-            }
-        }
-
-        if (section == nullptr) { // No section matches the RVA.
-            return 0;
-        }
+    // Find the corresponding section. If the VirtualSize of a section seems erroneous,
+    // the index falls back to its SizeOfRawData.
+    pSection section = _section_index ? _section_index->find(rva) : pSection();
+    if (section == nullptr) { // No section matches the RVA.
+        return 0;
     }
 
     // The sections have to be aligned on FileAlignment bytes.
@@ -563,8 +634,8 @@ unsigned int PE::_va_to_offset(boost::uint64_t va) const {
 
 // ----------------------------------------------------------------------------
 
-bool PE::_reach_directory(int directory) const {
-    if (_file_handle == nullptr) {
+bool PE::_reach_directory(int directory, FileCursor &cursor) const {
+    if (_file == nullptr) {
         return false;
     }
 
@@ -599,7 +670,7 @@ bool PE::_reach_directory(int directory) const {
 
     unsigned int offset = rva_to_offset(_ioh->directories[directory].VirtualAddress);
 
-    if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+    if (!offset || !cursor.seek(offset)) {
         PRINT_ERROR << "Could not reach the requested directory (offset=0x" << std::hex
                     << offset << ")." << DEBUG_INFO_INSIDEPE << std::endl;
         return false;
@@ -609,31 +680,24 @@ bool PE::_reach_directory(int directory) const {
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_directories() {
-    if (_file_handle == nullptr) {
-        return false;
+void PE::_parse_directory(std::once_flag &flag, bool (PE::*parser)() const) const {
+    if (_headers_only) {
+        return;
     }
-
-    _parse_imports();
-    _parse_delayed_imports();
-    _parse_exports();
-    _parse_resources();
-    _parse_debug();
-    _parse_relocations();
-    _parse_tls();
-    _parse_config();
-    _parse_certificates();
-    _parse_rich_header();
-    return true;
+    std::call_once(flag, [this, parser]() {
+        ParseBudget::Timer timer(_budget);
+        (this->*parser)();
+    });
 }
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_exports() {
-    if (!_ioh || _file_handle == nullptr) {
+bool PE::_parse_exports() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_EXPORT)) {
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_EXPORT, cursor)) {
         return true; // No exports
     }
 
@@ -643,7 +707,7 @@ bool PE::_parse_exports() {
     unsigned int ied_size = 9 * sizeof(boost::uint32_t) + 2 * sizeof(boost::uint16_t);
     memset(&ied, 0, ied_size);
 
-    if (ied_size != fread(&ied, 1, ied_size, _file_handle.get())) {
+    if (ied_size != cursor.read(&ied, ied_size)) {
         PRINT_ERROR << "Could not read the IMAGE_EXPORT_DIRECTORY." << std::endl;
         return false;
     }
@@ -661,8 +725,7 @@ bool PE::_parse_exports() {
 
     // Read the export name
     unsigned int offset = rva_to_offset(_ied->Name);
-    if (!offset ||
-        !utils::read_string_at_offset(_file_handle.get(), offset, _ied->NameStr)) {
+    if (!offset || !utils::read_string_at_offset(cursor, offset, _ied->NameStr)) {
         PRINT_ERROR << "Could not read the exported DLL name." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return true;
@@ -670,36 +733,53 @@ bool PE::_parse_exports() {
 
     // Get the address and ordinal of each exported function
     offset = rva_to_offset(_ied->AddressOfFunctions);
-    if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+    if (!offset || !cursor.seek(offset)) {
         PRINT_ERROR << "Could not reach exported functions address table."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
 
-    for (unsigned int i = 0; i < _ied->NumberOfFunctions; ++i) {
-        pexported_function ex = boost::make_shared<exported_function>();
-        if (4 != fread(&(ex->Address), 1, 4, _file_handle.get())) {
-            PRINT_ERROR << "Could not read an exported function's address."
-                        << DEBUG_INFO_INSIDEPE << std::endl;
-            return true;
-        }
+    // Read the whole address table at once. If it is truncated, keep the addresses
+    // which are present in the file.
+    std::vector<boost::uint32_t> addresses;
+    const boost::uint64_t available = cursor.remaining() / sizeof(boost::uint32_t);
+    bool truncated = _ied->NumberOfFunctions > available;
+    auto count = _budget.allowed_entries(truncated ? available : _ied->NumberOfFunctions,
+                                         "export table");
+    if (!_budget.consume(count * sizeof(boost::uint32_t), "export table")) {
+        return true;
+    }
+    cursor.read_array(addresses, static_cast<size_t>(count));
+
+    // If the address is located in the export directory, then it is a forwarded export.
+    const image_data_directory &export_dir =
+        _ioh->directories[IMAGE_DIRECTORY_ENTRY_EXPORT];
+    _exports->reserve(addresses.size());
+    for (unsigned int i = 0; i < addresses.size(); ++i) {
+        pexported_function ex = make_in_arena<exported_function>(_arena);
+        ex->Address = addresses[i];
         ex->Ordinal = _ied->Base + i;
 
-        // If the address is located in the export directory, then it is a forwarded
-        // export.
-        image_data_directory export_dir = _ioh->directories[IMAGE_DIRECTORY_ENTRY_EXPORT];
         if (ex->Address > export_dir.VirtualAddress &&
             ex->Address < export_dir.VirtualAddress + export_dir.Size) {
             offset = rva_to_offset(ex->Address);
-            if (!offset || !utils::read_string_at_offset(_file_handle.get(), offset,
-                                                         ex->ForwardName)) {
+            if (!offset ||
+                !utils::read_string_at_offset(cursor, offset, ex->ForwardName)) {
                 PRINT_ERROR << "Could not read a forwarded export name."
                             << DEBUG_INFO_INSIDEPE << std::endl;
                 return true;
             }
+            if (!_budget.consume(ex->ForwardName.size() + 1, "export table")) {
+                return true;
+            }
         }
 
-        _exports.push_back(ex);
+        _exports->push_back(ex);
+    }
+    if (truncated) {
+        PRINT_ERROR << "Could not read an exported function's address."
+                    << DEBUG_INFO_INSIDEPE << std::endl;
+        return true;
     }
 
     if (_ied->NumberOfNames == 0) {
@@ -707,121 +787,181 @@ bool PE::_parse_exports() {
     }
 
     // Associate possible exported names with the RVAs we just obtained. First, read the
-    // name and ordinal table.
-    boost::scoped_array<boost::uint32_t> names;
-    boost::scoped_array<boost::uint16_t> ords;
-    try {
-        // ied.NumberOfNames is an untrusted value. Allocate in a try-catch block to
-        // prevent crashes. See issue #1.
-        names.reset(new boost::uint32_t[_ied->NumberOfNames]);
-        ords.reset(new boost::uint16_t[_ied->NumberOfNames]);
-    } catch (const std::bad_alloc &) {
-        PRINT_ERROR << "Could not allocate an array big enough to hold exported name "
-                       "RVAs. This PE may have been manually crafted."
-                    << DEBUG_INFO_INSIDEPE << std::endl;
+    // name and ordinal table. ied.NumberOfNames is an untrusted value, but read_array
+    // does not allocate anything if the file is too small to contain the tables. See
+    // issue #1.
+    std::vector<boost::uint32_t> names;
+    std::vector<boost::uint16_t> ords;
+    auto number_of_names =
+        static_cast<size_t>(_budget.allowed_entries(_ied->NumberOfNames, "export table"));
+    const size_t name_entry_size = sizeof(boost::uint32_t) + sizeof(boost::uint16_t);
+    if (!_budget.consume(number_of_names * name_entry_size, "export table")) {
         return true;
     }
     offset = rva_to_offset(_ied->AddressOfNames);
-    if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+    if (!offset || !cursor.seek(offset)) {
         PRINT_ERROR << "Could not reach exported function's name table."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
 
-    if (_ied->NumberOfNames * sizeof(boost::uint32_t) !=
-        fread(names.get(), 1, _ied->NumberOfNames * sizeof(boost::uint32_t),
-              _file_handle.get())) {
+    if (!cursor.read_array(names, number_of_names)) {
         PRINT_ERROR << "Could not read an exported function's name address."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
 
     offset = rva_to_offset(_ied->AddressOfNameOrdinals);
-    if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+    if (!offset || !cursor.seek(offset)) {
         PRINT_ERROR << "Could not reach exported functions NameOrdinals table."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
-    if (_ied->NumberOfNames * sizeof(boost::uint16_t) !=
-        fread(ords.get(), 1, _ied->NumberOfNames * sizeof(boost::uint16_t),
-              _file_handle.get())) {
+    if (!cursor.read_array(ords, number_of_names)) {
         PRINT_ERROR << "Could not read an exported function's name ordinal."
                     << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
 
-    // Now match the names with with the exported addresses.
-    for (unsigned int i = 0; i < _ied->NumberOfNames; ++i) {
+    // Now match the names with with the exported addresses, and index them. When a
+    // name appears several times, the index keeps the first occurrence.
+    _exports_by_name.reserve(number_of_names);
+    for (size_t i = 0; i < number_of_names; ++i) {
         offset = rva_to_offset(names[i]);
-        if (!offset || ords[i] >= _exports.size() ||
-            !utils::read_string_at_offset(_file_handle.get(), offset,
-                                          _exports.at(ords[i])->Name)) {
+        if (!offset || ords[i] >= _exports->size() ||
+            !utils::read_string_at_offset(cursor, offset, _exports->at(ords[i])->Name)) {
             PRINT_ERROR << "Could not match an export name with its address!"
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return true;
         }
+        _exports_by_name.emplace(_exports->at(ords[i])->Name, _exports->at(ords[i]));
+        if (!_budget.consume(_exports->at(ords[i])->Name.size() + 1, "export table")) {
+            return true;
+        }
     }
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_relocations() {
-    if (!_ioh || _file_handle == nullptr) {
+pexported_function PE::find_export(const std::string &name) const {
+    if (!_initialized) {
+        return pexported_function();
+    }
+    _parse_directory(_exports_parsed, &PE::_parse_exports);
+    auto it = _exports_by_name.find(name);
+    return it == _exports_by_name.end() ? pexported_function() : it->second;
+}
+
+// ----------------------------------------------------------------------------
+
+pexported_function PE::find_export(boost::uint32_t ordinal) const {
+    if (!_initialized) {
+        return pexported_function();
+    }
+    _parse_directory(_exports_parsed, &PE::_parse_exports);
+
+    // Ordinals are the indexes of the address table, offset by the directory's Base.
+    if (!_ied || ordinal < _ied->Base || ordinal - _ied->Base >= _exports->size()) {
+        return pexported_function();
+    }
+    return _exports->at(ordinal - _ied->Base);
+}
+
+// ----------------------------------------------------------------------------
+
+bool PE::_parse_relocations() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
 
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_BASERELOC)) { // No relocation table
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_BASERELOC,
+                          cursor)) { // No relocation table
         return true;
     }
 
     unsigned int remaining_size = _ioh->directories[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size;
     unsigned int header_size = 2 * sizeof(boost::uint32_t);
+    bool success = true;
+
+    // All the relocations, which will be used to build the RelocationTable.
+    std::vector<relocation> flat;
+    flat.reserve(static_cast<size_t>(
+        std::min<boost::uint64_t>(remaining_size, cursor.remaining()) / 2));
+
     while (remaining_size > 0) {
-        pimage_base_relocation reloc = boost::make_shared<image_base_relocation>();
-        memset(reloc.get(), 0, header_size);
-        if (header_size != fread(reloc.get(), 1, header_size, _file_handle.get()) ||
-            reloc->BlockSize > remaining_size) {
+        image_base_relocation reloc = {0, 0};
+        if (!cursor.read_le(reloc.PageRVA) || !cursor.read_le(reloc.BlockSize) ||
+            reloc.BlockSize > remaining_size) {
             PRINT_ERROR << "Could not read an IMAGE_BASE_RELOCATION!"
                         << DEBUG_INFO_INSIDEPE << std::endl;
-            return false;
+            success = false;
+            break;
         }
 
         // It seems that sometimes, the end of the section is padded with zeroes. Break
         // here instead of reaching EOF. I have encountered this oddity in
         // 4d7ca8d467770f657305c16474b845fe.
-        if (reloc->BlockSize == 0) {
-            return true;
+        if (reloc.BlockSize == 0) {
+            break;
+        }
+        // A block cannot be smaller than its own header.
+        if (reloc.BlockSize < header_size) {
+            PRINT_ERROR << "Could not read an IMAGE_BASE_RELOCATION!"
+                        << DEBUG_INFO_INSIDEPE << std::endl;
+            success = false;
+            break;
         }
 
         // The remaining fields are an array of shorts. The number is deduced from the
         // block size.
-        for (unsigned int i = 0;
-             i < (reloc->BlockSize - header_size) / sizeof(boost::uint16_t); ++i) {
-            boost::uint16_t type_or_offset = 0;
-            if (sizeof(boost::uint16_t) !=
-                fread(&type_or_offset, 1, sizeof(boost::uint16_t), _file_handle.get())) {
-                PRINT_ERROR << "Could not read an IMAGE_BASE_RELOCATION's TypeOrOffset!"
-                            << DEBUG_INFO_INSIDEPE << std::endl;
-                return false;
+        unsigned int entries = (reloc.BlockSize - header_size) / sizeof(boost::uint16_t);
+        if (!_budget.check_entries(flat.size() + entries, "relocation table") ||
+            !_budget.consume(reloc.BlockSize, "relocation table")) {
+            break;
+        }
+        // The entries are decoded in place, directly into the flat table.
+        const boost::uint8_t *type_offsets = cursor.data();
+        if (entries > cursor.remaining() / sizeof(boost::uint16_t)) {
+            PRINT_ERROR << "Could not read an IMAGE_BASE_RELOCATION's TypeOrOffset!"
+                        << DEBUG_INFO_INSIDEPE << std::endl;
+            success = false;
+            break;
+        }
+
+        for (unsigned int i = 0; i < entries; ++i) {
+            boost::uint16_t type_offset =
+                type_offsets[2 * i] | (type_offsets[2 * i + 1] << 8);
+            relocation r = {reloc.PageRVA,
+                            static_cast<boost::uint16_t>(type_offset & 0xFFF),
+                            static_cast<boost::uint8_t>(type_offset >> 12)};
+            flat.push_back(r);
+
+            // The entry following an IMAGE_REL_BASED_HIGHADJ is not a relocation: it
+            // contains the low 16 bits of the value to adjust.
+            if (r.Type == 4) {
+                ++i;
             }
-            reloc->TypesOffsets.push_back(type_or_offset);
         }
 
-        _relocations.push_back(reloc);
-        remaining_size -= reloc->BlockSize;
+        cursor.skip(entries * sizeof(boost::uint16_t));
+        remaining_size -= reloc.BlockSize;
     }
-    return true;
+
+    _relocation_table = boost::make_shared<RelocationTable>(std::move(flat));
+    return success;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_tls() {
-    if (!_ioh || _file_handle == nullptr) {
+bool PE::_parse_tls() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
 
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_TLS)) { // No TLS callbacks
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_TLS, cursor)) { // No TLS callbacks
         return true;
     }
 
@@ -829,17 +969,19 @@ bool PE::_parse_tls() {
     unsigned int size = 4 * sizeof(boost::uint64_t) + 2 * sizeof(boost::uint32_t);
     memset(&tls, 0, size);
 
+    bool success;
     if (get_architecture() == x64) {
-        fread(&tls, 1, size, _file_handle.get());
+        success = (size == cursor.read(&tls, size));
     } else {
-        fread(&tls.StartAddressOfRawData, 1, sizeof(boost::uint32_t), _file_handle.get());
-        fread(&tls.EndAddressOfRawData, 1, sizeof(boost::uint32_t), _file_handle.get());
-        fread(&tls.AddressOfIndex, 1, sizeof(boost::uint32_t), _file_handle.get());
-        fread(&tls.AddressOfCallbacks, 1, sizeof(boost::uint32_t), _file_handle.get());
-        fread(&tls.SizeOfZeroFill, 1, 2 * sizeof(boost::uint32_t), _file_handle.get());
+        success = cursor.read_le(tls.StartAddressOfRawData, 4) &&
+                  cursor.read_le(tls.EndAddressOfRawData, 4) &&
+                  cursor.read_le(tls.AddressOfIndex, 4) &&
+                  cursor.read_le(tls.AddressOfCallbacks, 4) &&
+                  cursor.read_le(tls.SizeOfZeroFill) &&
+                  cursor.read_le(tls.Characteristics);
     }
 
-    if (feof(_file_handle.get()) || ferror(_file_handle.get())) {
+    if (!success) {
         PRINT_ERROR << "Could not read the IMAGE_TLS_DIRECTORY." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return true; // Non-fatal
@@ -847,7 +989,7 @@ bool PE::_parse_tls() {
 
     // Go to the offset table
     unsigned int offset = _va_to_offset(tls.AddressOfCallbacks);
-    if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+    if (!offset || !cursor.seek(offset)) {
         PRINT_ERROR << "Could not reach the TLS callback table." << DEBUG_INFO_INSIDEPE
                     << std::endl;
         return true; // Non-fatal
@@ -855,20 +997,22 @@ bool PE::_parse_tls() {
 
     boost::uint64_t callback_address = 0;
     unsigned int callback_size =
-        _ioh->Magic == nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32+")
-            ? sizeof(boost::uint64_t)
-            : sizeof(boost::uint32_t);
+        _ioh->Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC ? sizeof(boost::uint64_t)
+                                                     : sizeof(boost::uint32_t);
     while (true) // break on null callback
     {
-        if (callback_size !=
-                fread(&callback_address, 1, callback_size, _file_handle.get()) ||
+        if (!cursor.read_le(callback_address, callback_size) ||
             !callback_address) { // Exit condition.
             break;
         }
+        if (!_budget.check_entries(tls.Callbacks.size() + 1, "TLS callback table") ||
+            !_budget.consume(callback_size, "TLS callback table")) {
+            break;
+        }
         tls.Callbacks.push_back(callback_address);
     }
 
-    _tls.reset(tls);
+    _tls = boost::make_shared<image_tls_directory>(tls);
     return true;
 }
 
@@ -880,7 +1024,7 @@ bool PE::_parse_tls() {
  *			bytes available.
  *
  *	@param	config		The structure that was read so far.
- *	@param	source		A pointer to the file to read from.
+ *	@param	source		A cursor to read from.
  *	@param	destination	Where the read value is to be put.
  *	@param	field_size	The size of the value to read.
  *	@param	read_bytes	The number of bytes read so far, will be incremented.
@@ -888,13 +1032,13 @@ bool PE::_parse_tls() {
  *	@return	Whether the value should be read. If false, EOF has been reached or
  *			the structure has no more fields to read.
  */
-bool read_config_field(const image_load_config_directory &config, FILE *source,
+bool read_config_field(const image_load_config_directory &config, FileCursor &source,
                        void *destination, unsigned int field_size,
                        unsigned int &read_bytes) {
     if (read_bytes + field_size > config.Size) {
         return false;
     }
-    if (1 != fread(destination, field_size, 1, source)) {
+    if (field_size != source.read(destination, field_size)) {
         return false;
     }
     read_bytes += field_size;
@@ -903,18 +1047,20 @@ bool read_config_field(const image_load_config_directory &config, FILE *source,
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_config() {
-    if (!_ioh || _file_handle == nullptr) {
+bool PE::_parse_config() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
 
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG)) { // No load configuration
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG,
+                          cursor)) { // No load configuration
         return true;
     }
 
     image_load_config_directory config;
     memset(&config, 0, sizeof(config));
-    if (24 != fread(&config, 1, 24, _file_handle.get())) {
+    if (24 != cursor.read(&config, 24)) {
         PRINT_WARNING << "Error while reading the IMAGE_LOAD_CONFIG_DIRECTORY!"
                       << DEBUG_INFO_INSIDEPE << std::endl;
         return true; // Non fatal
@@ -922,30 +1068,28 @@ bool PE::_parse_config() {
 
     // The next few fields are uint32s or uint64s depending on the architecture.
     unsigned int field_size =
-        (_ioh->Magic == nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32")) ? 4 : 8;
-    if (1 != fread(&config.DeCommitFreeBlockThreshold, field_size, 1,
-                   _file_handle.get()) ||
-        1 != fread(&config.DeCommitTotalFreeThreshold, field_size, 1,
-                   _file_handle.get()) ||
-        1 != fread(&config.LockPrefixTable, field_size, 1, _file_handle.get()) ||
-        1 != fread(&config.MaximumAllocationSize, field_size, 1, _file_handle.get()) ||
-        1 != fread(&config.VirtualMemoryThreshold, field_size, 1, _file_handle.get()) ||
-        1 != fread(&config.ProcessAffinityMask, field_size, 1, _file_handle.get())) {
+        (_ioh->Magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC) ? 4 : 8;
+    if (!cursor.read_le(config.DeCommitFreeBlockThreshold, field_size) ||
+        !cursor.read_le(config.DeCommitTotalFreeThreshold, field_size) ||
+        !cursor.read_le(config.LockPrefixTable, field_size) ||
+        !cursor.read_le(config.MaximumAllocationSize, field_size) ||
+        !cursor.read_le(config.VirtualMemoryThreshold, field_size) ||
+        !cursor.read_le(config.ProcessAffinityMask, field_size)) {
         PRINT_WARNING << "Error while reading the IMAGE_LOAD_CONFIG_DIRECTORY!"
                       << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
 
     // Then a few fields have the same size on x86 and x64.
-    if (8 != fread(&config.ProcessHeapFlags, 1, 8, _file_handle.get())) {
+    if (8 != cursor.read(&config.ProcessHeapFlags, 8)) {
         PRINT_WARNING << "Error while reading the IMAGE_LOAD_CONFIG_DIRECTORY!"
                       << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
     }
 
     // The last fields have a variable size depending on the architecture again.
-    if (1 != fread(&config.EditList, field_size, 1, _file_handle.get()) ||
-        1 != fread(&config.SecurityCookie, field_size, 1, _file_handle.get())) {
+    if (!cursor.read_le(config.EditList, field_size) ||
+        !cursor.read_le(config.SecurityCookie, field_size)) {
         PRINT_WARNING << "Error while reading the IMAGE_LOAD_CONFIG_DIRECTORY!"
                       << DEBUG_INFO_INSIDEPE << std::endl;
         return true;
@@ -957,8 +1101,8 @@ bool PE::_parse_config() {
     // (https://msdn.microsoft.com/en-us/library/windows/desktop/ms680328(v=vs.85).aspx).
     // Those fields should be 0 in 64 bit binaries.
     if (config.Size > read_bytes) {
-        if (1 != fread(&config.SEHandlerTable, field_size, 1, _file_handle.get()) ||
-            1 != fread(&config.SEHandlerCount, field_size, 1, _file_handle.get())) {
+        if (!cursor.read_le(config.SEHandlerTable, field_size) ||
+            !cursor.read_le(config.SEHandlerCount, field_size)) {
             PRINT_WARNING << "Error while reading the IMAGE_LOAD_CONFIG_DIRECTORY!"
                           << DEBUG_INFO_INSIDEPE << std::endl;
             return true;
@@ -970,56 +1114,50 @@ bool PE::_parse_config() {
     // returns false, i.e. when trying to read more bytes than are available in the
     // structure. This construction is necessary because fields are added to the structure
     // as Windows evolves.
-    read_config_field(config, _file_handle.get(), &config.GuardCFCheckFunctionPointer,
-                      field_size, read_bytes) ||
-        read_config_field(config, _file_handle.get(),
-                          &config.GuardCFDispatchFunctionPointer, field_size,
-                          read_bytes) ||
-        read_config_field(config, _file_handle.get(), &config.GuardCFFunctionTable,
-                          field_size, read_bytes) ||
-        read_config_field(config, _file_handle.get(), &config.GuardCFFunctionCount,
+    read_config_field(config, cursor, &config.GuardCFCheckFunctionPointer, field_size,
+                      read_bytes) ||
+        read_config_field(config, cursor, &config.GuardCFDispatchFunctionPointer,
                           field_size, read_bytes) ||
-        read_config_field(config, _file_handle.get(), &config.GuardFlags, 4,
+        read_config_field(config, cursor, &config.GuardCFFunctionTable, field_size,
                           read_bytes) ||
-        read_config_field(config, _file_handle.get(), &config.CodeIntegrity, 12,
+        read_config_field(config, cursor, &config.GuardCFFunctionCount, field_size,
                           read_bytes) ||
-        read_config_field(config, _file_handle.get(),
-                          &config.GuardAddressTakenIatEntryTable, field_size,
-                          read_bytes) ||
-        read_config_field(config, _file_handle.get(),
-                          &config.GuardAddressTakenIatEntryCount, field_size,
-                          read_bytes) ||
-        read_config_field(config, _file_handle.get(), &config.GuardLongJumpTargetTable,
+        read_config_field(config, cursor, &config.GuardFlags, 4, read_bytes) ||
+        read_config_field(config, cursor, &config.CodeIntegrity, 12, read_bytes) ||
+        read_config_field(config, cursor, &config.GuardAddressTakenIatEntryTable,
+                          field_size, read_bytes) ||
+        read_config_field(config, cursor, &config.GuardAddressTakenIatEntryCount,
                           field_size, read_bytes) ||
-        read_config_field(config, _file_handle.get(), &config.GuardLongJumpTargetCount,
-                          field_size, read_bytes);
+        read_config_field(config, cursor, &config.GuardLongJumpTargetTable, field_size,
+                          read_bytes) ||
+        read_config_field(config, cursor, &config.GuardLongJumpTargetCount, field_size,
+                          read_bytes);
 
-    _config.reset(config);
+    _config = boost::make_shared<image_load_config_directory>(config);
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_certificates() {
-    if (!_ioh || _file_handle == nullptr) {
+bool PE::_parse_certificates() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
 
+    FileCursor cursor(_file);
     if (!_ioh->directories[IMAGE_DIRECTORY_ENTRY_SECURITY]
              .VirtualAddress || // In this case, "VirtualAddress" is actually a file
                                 // offset.
-        fseek(_file_handle.get(),
-              _ioh->directories[IMAGE_DIRECTORY_ENTRY_SECURITY].VirtualAddress,
-              SEEK_SET)) {
+        !cursor.seek(_ioh->directories[IMAGE_DIRECTORY_ENTRY_SECURITY].VirtualAddress)) {
         return true; // Unsigned binary
     }
 
     unsigned int remaining_bytes = _ioh->directories[IMAGE_DIRECTORY_ENTRY_SECURITY].Size;
     unsigned int header_size = sizeof(boost::uint32_t) + 2 * sizeof(boost::uint16_t);
     while (remaining_bytes > header_size) {
-        pwin_certificate cert = boost::make_shared<win_certificate>();
+        pwin_certificate cert = make_in_arena<win_certificate>(_arena);
         memset(cert.get(), 0, header_size);
-        if (header_size != fread(cert.get(), 1, header_size, _file_handle.get())) {
+        if (header_size != cursor.read(cert.get(), header_size)) {
             PRINT_WARNING << "Could not read a WIN_CERTIFICATE's header." << std::endl;
             return true; // Recoverable error.
         }
@@ -1027,10 +1165,8 @@ bool PE::_parse_certificates() {
         // The certificate may point to garbage. Although other values than the ones
         // defined in nt_values.h are allowed by the PE specification (but which ones?),
         // this is a good heuristic to determine whether we have landed in random bytes.
-        if (*nt::translate_to_flag(cert->CertificateType, nt::WIN_CERTIFICATE_TYPES) ==
-                "UNKNOWN" &&
-            *nt::translate_to_flag(cert->Revision, nt::WIN_CERTIFICATE_REVISIONS) ==
-                "UNKNOWN") {
+        if (nt::WIN_CERTIFICATE_TYPES.find(cert->CertificateType) == nullptr &&
+            nt::WIN_CERTIFICATE_REVISIONS.find(cert->Revision) == nullptr) {
             PRINT_WARNING << "The WIN_CERTIFICATE appears to be invalid."
                           << DEBUG_INFO_INSIDEPE << std::endl;
             return true; // Recoverable error.
@@ -1044,6 +1180,12 @@ bool PE::_parse_certificates() {
             // Get the certificate data anyway.
         }
 
+        // The allocation below is sized by an untrusted field.
+        if (!_budget.check_entries(_certificates->size() + 1, "certificate table") ||
+            !_budget.consume(cert->Length, "certificate table")) {
+            return true;
+        }
+
         try {
             cert->Certificate.resize(cert->Length);
         } catch (const std::exception &e) {
@@ -1053,20 +1195,19 @@ bool PE::_parse_certificates() {
         }
 
         if (cert->Length < remaining_bytes ||
-            cert->Length - header_size != fread(&(cert->Certificate[0]), 1,
-                                                cert->Length - header_size,
-                                                _file_handle.get())) {
+            cert->Length - header_size !=
+                cursor.read(&(cert->Certificate[0]), cert->Length - header_size)) {
             PRINT_ERROR << "Could not read a WIN_CERTIFICATE's data."
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
         }
         remaining_bytes -= cert->Length;
-        _certificates.push_back(cert);
+        _certificates->push_back(cert);
 
         // The certificates start on 8-byte aligned addresses
         unsigned int padding = cert->Length % 8;
         if (padding && remaining_bytes) {
-            fseek(_file_handle.get(), padding, SEEK_CUR);
+            cursor.skip(padding);
             remaining_bytes -= padding;
         }
     }
@@ -1076,65 +1217,80 @@ bool PE::_parse_certificates() {
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_rich_header() {
-    if (!_h_dos || _file_handle == nullptr) {
+bool PE::_parse_rich_header() const {
+    if (!_h_dos || _file == nullptr) {
         return false;
     }
 
-    // Start searching for the RICH header at offset 0, but before the PE header.
-    if (fseek(_file_handle.get(), 0, SEEK_SET)) {
-        return true;
+    // Look for the RICH magic among the DWORDs located before the PE header.
+    const boost::uint8_t *data = _file->data();
+    const int limit = _h_dos->e_lfanew;
+    size_t dwords = limit > 0 ? (static_cast<size_t>(limit) + 3) / 4 : 1;
+    dwords = static_cast<size_t>(std::min<boost::uint64_t>(dwords, _file->size() / 4));
+    size_t rich_offset = 4 * utils::find_dword(data, dwords, 0x6863'6952);
+    if (rich_offset == 4 * dwords) {
+        return true; // The RICH magic was not found.
     }
 
-    unsigned int read;
-    int bytes_left = _h_dos->e_lfanew;
-
-    do {
-        if (1 != fread(&read, 4, 1, _file_handle.get())) {
-            break;
-        }
-        bytes_left -= 4; // Stay between offset 0x80 and the PE header.
-    } while (read != 0x6863'6952 && bytes_left > 0);
+    auto read_dword = [data](size_t offset) -> boost::uint32_t {
+        boost::uint32_t value;
+        memcpy(&value, data + offset, sizeof(value));
+        return value;
+    };
 
-    if (read != 0x6863'6952) {
-        return true; // The RICH magic was not found.
-    }
     rich_header h;
-    if (1 != fread(&h.xor_key, 4, 1, _file_handle.get())) {
+    if (rich_offset + 8 > _file->size()) {
         PRINT_WARNING << "XOR key absent after the RICH header!" << DEBUG_INFO_INSIDEPE
                       << std::endl;
         return true;
     }
+    h.xor_key = read_dword(rich_offset + 4);
 
-    // Start parsing the values backwards.
-    while (true) {
-        if (fseek(_file_handle.get(), -16, SEEK_CUR)) {
+    // Go back to the start marker, "DanS". The @comp.ids are located between the two.
+    size_t start = rich_offset;
+    do {
+        if (start < 8) {
             PRINT_WARNING << "Error while reading the RICH header!" << DEBUG_INFO_INSIDEPE
                           << std::endl;
             return true;
         }
-        boost::uint64_t data;
-        if (1 != fread(&data, 8, 1, _file_handle.get())) {
-            PRINT_WARNING << "Error while reading the RICH header!" << DEBUG_INFO_INSIDEPE
-                          << std::endl;
-            return true;
+        start -= 8;
+    } while ((read_dword(start) ^ h.xor_key) != 0x536E'6144);
+
+    // Keep a trace of where this header starts, as it is not easy to locate and is useful
+    // to calculate the checksum.
+    h.file_offset = static_cast<boost::uint32_t>(start);
+
+    // Checksum of the DOS header, ignoring e_lfanew.
+    h.checksum = h.file_offset;
+    for (boost::uint32_t i = 0; i < h.file_offset; ++i) {
+        if (i < 0x3c || 0x40 <= i) {
+            h.checksum += utils::rol32(data[i], i);
         }
-        boost::uint32_t count = (data >> 32) ^ h.xor_key;
-        boost::uint32_t id_value = (data & 0xFFFF'FFFF) ^ h.xor_key;
+    }
 
-        // Stop if we reach the start marker, "DanS".
-        if (id_value == 0x536E'6144) {
-            break;
+    // Decode the @comp.ids, and hash the cleartext header at the same time (FNV-1a).
+    boost::uint64_t hash = 0xcbf2'9ce4'8422'2325;
+    auto hash_dword = [&hash](boost::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * 0x100'0000'01b3;
         }
-        auto t = std::make_tuple(static_cast<boost::uint16_t>((id_value >> 16) & 0xFFFF),
-                                 static_cast<boost::uint16_t>(id_value & 0xFFFF), count);
-        h.values.insert(h.values.begin(), t);
     };
-
-    // Keep a trace of where this header starts, as it is not easy to locate and is useful
-    // to calculate the checksum.
-    h.file_offset = ftell(_file_handle.get()) - 8;
-    _rich_header.reset(h);
+    hash_dword(0x536E'6144);
+    hash_dword(read_dword(start + 4) ^ h.xor_key);
+    h.values.reserve((rich_offset - start) / 8 - 1);
+    for (size_t offset = start + 8; offset < rich_offset; offset += 8) {
+        boost::uint32_t id_value = read_dword(offset) ^ h.xor_key;
+        boost::uint32_t count = read_dword(offset + 4) ^ h.xor_key;
+        hash_dword(id_value);
+        hash_dword(count);
+        h.values.emplace_back(static_cast<boost::uint16_t>((id_value >> 16) & 0xFFFF),
+                              static_cast<boost::uint16_t>(id_value & 0xFFFF), count);
+        h.checksum += utils::rol32(id_value, count);
+    }
+    h.fnv_hash = hash;
+
+    _rich_header = boost::make_shared<rich_header>(h);
     return true;
 }
 
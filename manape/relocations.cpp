@@ -0,0 +1,85 @@
+/*
+    This file is part of Manalyze.
+
+    Manalyze is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Manalyze is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "manape/relocations.h"
+
+namespace mana::pe {
+
+RelocationTable::RelocationTable(std::vector<relocation> relocations)
+    : _relocations(std::move(relocations)) {
+    _relocations.erase(std::remove_if(_relocations.begin(), _relocations.end(),
+                                      [](const relocation &r) { return r.Type == 0; }),
+                       _relocations.end());
+
+    // Blocks are normally sorted already, in which case there is nothing to do.
+    auto by_rva = [](const relocation &a, const relocation &b) {
+        return get_rva(a) < get_rva(b);
+    };
+    if (!std::is_sorted(_relocations.begin(), _relocations.end(), by_rva)) {
+        std::stable_sort(_relocations.begin(), _relocations.end(), by_rva);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int RelocationTable::get_relocated_size(const relocation &r) {
+    switch (r.Type) {
+    case 1: // IMAGE_REL_BASED_HIGH
+    case 2: // IMAGE_REL_BASED_LOW
+    case 4: // IMAGE_REL_BASED_HIGHADJ
+        return 2;
+    case 7:  // IMAGE_REL_BASED_THUMB_MOV32 (a MOVW / MOVT pair)
+    case 10: // IMAGE_REL_BASED_DIR64
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool RelocationTable::is_relocated(boost::uint32_t rva) const {
+    // No relocation patches more than 8 bytes, so only the ones starting in the 8 bytes
+    // preceding the address need to be checked.
+    auto range = find_range(rva < 7 ? 0 : rva - 7, rva + 1);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (rva < get_rva(*it) + get_relocated_size(*it)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+std::pair<RelocationTable::const_iterator, RelocationTable::const_iterator>
+RelocationTable::find_range(boost::uint32_t start, boost::uint32_t end) const {
+    auto first = std::lower_bound(
+        _relocations.begin(), _relocations.end(), start,
+        [](const relocation &r, boost::uint32_t rva) { return get_rva(r) < rva; });
+    auto last = std::lower_bound(
+        first, _relocations.end(), end,
+        [](const relocation &r, boost::uint32_t rva) { return get_rva(r) < rva; });
+    if (end < start) {
+        last = first;
+    }
+    return std::make_pair(first, last);
+}
+
+} // namespace mana::pe
@@ -20,14 +20,18 @@ along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 // was getting way too big. It made sense (at least semantically) to move
 // them here.
 
+#include <atomic>
+#include <unordered_set>
+
+#include "manape/file_writer.h"
 #include "manape/pe.h" 
 #include "manape/resources.h"
 
 namespace mana::pe {
 
-bool PE::_read_image_resource_directory(image_resource_directory &dir,
+bool PE::_read_image_resource_directory(FileCursor &cursor, image_resource_directory &dir,
                                         unsigned int offset) const {
-    if (!_ioh || _file_handle == nullptr) {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
 
@@ -35,7 +39,7 @@ bool PE::_read_image_resource_directory(image_resource_directory &dir,
         offset = rva_to_offset(
                      _ioh->directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress) +
                  offset;
-        if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+        if (!offset || !cursor.seek(offset)) {
             PRINT_ERROR << "Could not reach an IMAGE_RESOURCE_DIRECTORY."
                         << DEBUG_INFO_INSIDEPE << std::endl;
             return false;
@@ -44,7 +48,7 @@ bool PE::_read_image_resource_directory(image_resource_directory &dir,
 
     unsigned int size = 2 * sizeof(boost::uint32_t) + 4 * sizeof(boost::uint16_t);
     dir.Entries.clear();
-    if (size != fread(&dir, 1, size, _file_handle.get())) {
+    if (size != cursor.read(&dir, size)) {
         CAPPED_LOGGING
         PRINT_ERROR << "Could not read an IMAGE_RESOURCE_DIRECTORY."
                     << DEBUG_INFO_INSIDEPE << std::endl;
@@ -72,27 +76,37 @@ bool PE::_read_image_resource_directory(image_resource_directory &dir,
         CAPPED_LOGGING_END
     }
 
-    for (auto i = 0; i < dir.NumberOfIdEntries + dir.NumberOfNamedEntries; ++i) {
-        auto entry = boost::make_shared<image_resource_directory_entry>();
-        size = 2 * sizeof(boost::uint32_t);
-        memset(entry.get(), 0, size);
-        if (size != fread(entry.get(), 1, size, _file_handle.get())) {
-            PRINT_ERROR << "Could not read an IMAGE_RESOURCE_DIRECTORY_ENTRY."
-                        << DEBUG_INFO_INSIDEPE << std::endl;
-            return false;
-        }
+    // Read all the entries at once. Each of them is made of two uint32s: NameOrId and
+    // OffsetToData.
+    unsigned int number_of_entries = dir.NumberOfIdEntries + dir.NumberOfNamedEntries;
+    if (!_budget.consume(size + 2 * sizeof(boost::uint32_t) * number_of_entries,
+                         "resource table")) {
+        return false;
+    }
+    std::vector<boost::uint32_t> raw_entries;
+    if (!cursor.read_array(raw_entries, 2 * number_of_entries)) {
+        PRINT_ERROR << "Could not read an IMAGE_RESOURCE_DIRECTORY_ENTRY."
+                    << DEBUG_INFO_INSIDEPE << std::endl;
+        return false;
+    }
+
+    dir.Entries.reserve(number_of_entries);
+    for (unsigned int i = 0; i < number_of_entries; ++i) {
+        image_resource_directory_entry entry;
+        entry.NameOrId = raw_entries[2 * i];
+        entry.OffsetToData = raw_entries[2 * i + 1];
 
         // For named entries, NameOrId is a RVA to a string: retrieve it and NameOrId has
         // high bit set to 1.
-        if (entry->NameOrId & 0x8000'0000) {
+        if (entry.NameOrId & 0x8000'0000) {
             // The offset of the string is relative
             auto name_offset =
                 rva_to_offset(
                     _ioh->directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress) +
-                (entry->NameOrId & 0x7FFF'FFFF);
+                (entry.NameOrId & 0x7FFF'FFFF);
             if (!name_offset ||
-                !utils::read_string_at_offset(_file_handle.get(), name_offset,
-                                              entry->NameStr, true)) {
+                !utils::read_string_at_offset(cursor, name_offset, entry.NameStr,
+                                              true)) {
                 PRINT_ERROR << "Could not read an IMAGE_RESOURCE_DIRECTORY_ENTRY's name."
                             << DEBUG_INFO_INSIDEPE << std::endl;
                 return false;
@@ -100,7 +114,7 @@ bool PE::_read_image_resource_directory(image_resource_directory &dir,
         }
 
         // Immediately reject obvious bogus entries.
-        if ((entry->OffsetToData & 0x7FFF'FFFF) > _file_size) {
+        if ((entry.OffsetToData & 0x7FFF'FFFF) > _file_size) {
             CAPPED_LOGGING
             PRINT_WARNING << "Ignored an invalid IMAGE_RESOURCE_DIRECTORY_ENTRY."
                           << DEBUG_INFO_INSIDEPE << std::endl;
@@ -108,7 +122,7 @@ bool PE::_read_image_resource_directory(image_resource_directory &dir,
             continue;
         }
 
-        dir.Entries.push_back(entry);
+        dir.Entries.push_back(std::move(entry));
     }
 
     return true;
@@ -116,56 +130,69 @@ bool PE::_read_image_resource_directory(image_resource_directory &dir,
 
 // ----------------------------------------------------------------------------
 
-bool PE::_parse_resources() {
-    if (!_ioh || _file_handle == nullptr) {
+bool PE::_parse_resources() const {
+    if (!_ioh || _file == nullptr) {
         return false;
     }
-    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_RESOURCE)) { // No resources.
+    FileCursor cursor(_file);
+    if (!_reach_directory(IMAGE_DIRECTORY_ENTRY_RESOURCE, cursor)) { // No resources.
         return true;
     }
 
     image_resource_directory root;
-    if (!_read_image_resource_directory(root)) {
+    if (!_read_image_resource_directory(cursor, root)) {
         return false;
     }
 
+    // The (offset, size) pairs of the resources read so far, used to detect duplicates.
+    std::unordered_set<boost::uint64_t> known_resources;
+    boost::uint64_t visited = 0;
+
     // Read Type directories
-    for (std::vector<pimage_resource_directory_entry>::iterator it = root.Entries.begin();
+    for (std::vector<image_resource_directory_entry>::iterator it = root.Entries.begin();
          it != root.Entries.end(); ++it) {
         image_resource_directory type;
-        if (!_read_image_resource_directory(type, (*it)->OffsetToData & 0x7FFF'FFFF)) {
+        if (!_read_image_resource_directory(cursor, type,
+                                            it->OffsetToData & 0x7FFF'FFFF)) {
             continue;
         }
 
         // Read Name directory
-        for (std::vector<pimage_resource_directory_entry>::iterator it2 =
+        for (std::vector<image_resource_directory_entry>::iterator it2 =
                  type.Entries.begin();
              it2 != type.Entries.end(); ++it2) {
             image_resource_directory name;
-            if (!_read_image_resource_directory(name,
-                                                (*it2)->OffsetToData & 0x7FFF'FFFF)) {
+            if (!_read_image_resource_directory(cursor, name,
+                                                it2->OffsetToData & 0x7FFF'FFFF)) {
                 continue;
             }
 
             // Read the IMAGE_RESOURCE_DATA_ENTRY
-            for (std::vector<pimage_resource_directory_entry>::iterator it3 =
+            for (std::vector<image_resource_directory_entry>::iterator it3 =
                      name.Entries.begin();
                  it3 != name.Entries.end(); ++it3) {
+                // Directories may point to each other, so a small table can describe a
+                // huge tree.
+                const char *directory = "resource table";
+                if (!_budget.check_entries(++visited, directory) ||
+                    !_budget.consume(sizeof(image_resource_data_entry), directory)) {
+                    return true;
+                }
+
                 image_resource_data_entry entry;
                 memset(&entry, 0, sizeof(image_resource_data_entry));
 
                 unsigned int offset = rva_to_offset(
                     _ioh->directories[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress +
-                    ((*it3)->OffsetToData & 0x7FFF'FFFF));
-                if (!offset || fseek(_file_handle.get(), offset, SEEK_SET)) {
+                    (it3->OffsetToData & 0x7FFF'FFFF));
+                if (!offset || !cursor.seek(offset)) {
                     PRINT_ERROR << "Could not reach an IMAGE_RESOURCE_DATA_ENTRY."
                                 << DEBUG_INFO_INSIDEPE << std::endl;
                     return false;
                 }
 
                 if (sizeof(image_resource_data_entry) !=
-                    fread(&entry, 1, sizeof(image_resource_data_entry),
-                          _file_handle.get())) {
+                    cursor.read(&entry, sizeof(image_resource_data_entry))) {
                     PRINT_ERROR << "Could not read an IMAGE_RESOURCE_DATA_ENTRY."
                                 << DEBUG_INFO_INSIDEPE << std::endl;
                     return false;
@@ -185,26 +212,11 @@ bool PE::_parse_resources() {
                 std::string r_language;
                 int id = 0;
 
-                // Translate resource type.
-                if ((*it)->NameOrId & 0x8000'0000) { // NameOrId is an offset to a string,
-                                                     // we already recovered it
-                    r_type = (*it)->NameStr;
-                } else { // Otherwise, it's a MAKERESOURCEINT constant.
-                    r_type = *nt::translate_to_flag((*it)->NameOrId, nt::RESOURCE_TYPES);
-                }
-
                 // Translate resource name
-                if ((*it2)->NameOrId & 0x8000'0000) {
-                    r_name = (*it2)->NameStr;
+                if (it2->NameOrId & 0x8000'0000) {
+                    r_name = it2->NameStr;
                 } else {
-                    id = (*it2)->NameOrId;
-                }
-
-                // Translate the language.
-                if ((*it3)->NameOrId & 0x8000'0000) {
-                    r_language = (*it3)->NameStr;
-                } else {
-                    r_language = *nt::translate_to_flag((*it3)->NameOrId, nt::LANG_IDS);
+                    id = it2->NameOrId;
                 }
 
                 offset = rva_to_offset(entry.OffsetToData);
@@ -223,6 +235,7 @@ bool PE::_parse_resources() {
                 }
                 pResource res;
                 if (entry.Size == 0) {
+                    CAPPED_LOGGING
                     if (r_name != "") {
                         PRINT_WARNING << "Resource " << r_name << " has a size of 0!"
                                       << DEBUG_INFO_INSIDEPE << std::endl;
@@ -230,43 +243,52 @@ bool PE::_parse_resources() {
                         PRINT_WARNING << "Resource " << id << " has a size of 0!"
                                       << DEBUG_INFO_INSIDEPE << std::endl;
                     }
+                    CAPPED_LOGGING_END
                     continue;
                 }
 
                 // Sanity check: verify that no resource is already pointing to the given
                 // offset.
-                bool is_malformed = false;
-                for (auto it4 = _resource_table.begin(); it4 != _resource_table.end();
-                     ++it4) {
-                    if (*it4 != nullptr && (*it4)->get_offset() == offset &&
-                        (*it4)->get_size() == entry.Size) {
-                        // Only print this error message once to avoid flooding stderr.
-                        static bool warned_once = false;
-                        if (!warned_once) {
-                            PRINT_WARNING << "The PE contains duplicate resources. It "
-                                             "was almost certainly crafted manually."
-                                          << DEBUG_INFO_INSIDEPE << std::endl;
-                            warned_once = true;
-                        }
-                        is_malformed = true;
-                        break;
+                if (!known_resources
+                         .insert(static_cast<boost::uint64_t>(offset) << 32 | entry.Size)
+                         .second) {
+                    // Only print this error message once to avoid flooding stderr.
+                    static std::atomic<bool> warned_once(false);
+                    if (!warned_once.exchange(true)) {
+                        PRINT_WARNING << "The PE contains duplicate resources. It was "
+                                         "almost certainly crafted manually."
+                                      << DEBUG_INFO_INSIDEPE << std::endl;
                     }
+                    continue; // Duplicate resource. Do not add it again.
                 }
-                if (is_malformed) { // Duplicate resource. Do not add it again.
-                    continue;
+
+                // Translate resource type. This is only done now, because crafted trees
+                // may contain huge numbers of duplicates.
+                if (it->NameOrId & 0x8000'0000) { // NameOrId is an offset to a string,
+                                                  // we already recovered it
+                    r_type = it->NameStr;
+                } else { // Otherwise, it's a MAKERESOURCEINT constant.
+                    r_type = *nt::translate_to_flag(it->NameOrId, nt::RESOURCE_TYPES);
+                }
+
+                // Translate the language.
+                if (it3->NameOrId & 0x8000'0000) {
+                    r_language = it3->NameStr;
+                } else {
+                    r_language = *nt::translate_to_flag(it3->NameOrId, nt::LANG_IDS);
                 }
 
                 if (r_name != "") {
-                    res = boost::make_shared<Resource>(r_type, r_name, r_language,
-                                                       entry.Codepage, entry.Size,
-                                                       name.TimeDateStamp, offset, _path);
+                    res = make_in_arena<Resource>(_arena, r_type, r_name, r_language,
+                                                  entry.Codepage, entry.Size,
+                                                  name.TimeDateStamp, offset, _file);
                 } else { // No name: call the constructor with the resource ID instead.
-                    res = boost::make_shared<Resource>(r_type, id, r_language,
-                                                       entry.Codepage, entry.Size,
-                                                       name.TimeDateStamp, offset, _path);
+                    res = make_in_arena<Resource>(_arena, r_type, id, r_language,
+                                                  entry.Codepage, entry.Size,
+                                                  name.TimeDateStamp, offset, _file);
                 }
 
-                _resource_table.push_back(res);
+                _resource_table->push_back(res);
             }
         }
     }
@@ -276,62 +298,48 @@ bool PE::_parse_resources() {
 
 // ----------------------------------------------------------------------------
 
-shared_bytes Resource::get_raw_data() const {
-    auto res = boost::make_shared<std::vector<boost::uint8_t>>();
-
-    FILE *f = _reach_data();
-    size_t read_bytes;
-    if (f == nullptr) {
-        goto END;
+ByteView Resource::get_raw_view() const {
+    if (!_reach_data()) {
+        return ByteView();
     }
 
-// Linux doesn't throw std::bad_alloc, instead it has OOM Killer shutdown the process.
-// This workaround prevents Manalyze from crashing by bounding how much memory can be
-// requested.
-#ifdef BOOST_POSIX_API
-    struct stat st;
-    stat(_path_to_pe.c_str(), &st);
-    if (_size > st.st_size) {
+    if (_size > _file->size()) {
         PRINT_ERROR << "Resource " << *get_name()
                     << " is bigger than the PE. Not trying to load it in memory."
                     << DEBUG_INFO << std::endl;
-        return res;
+        return ByteView();
     }
-#endif
 
+    // If the resource goes past the end of the file, the view is truncated.
+    return ByteView(_file, _offset_in_file, _size);
+}
+
+// ----------------------------------------------------------------------------
+
+shared_bytes Resource::get_raw_data() const {
+    ByteView view = get_raw_view();
     try {
-        res->resize(_size);
+        return view.to_vector();
     } catch (const std::exception &e) {
         PRINT_ERROR << "Failed to allocate enough space for resource " << *get_name()
                     << "! (" << e.what() << ")" << DEBUG_INFO << std::endl;
-        return res;
-    }
-    read_bytes = fread(&(*res)[0], 1, _size, f);
-    if (read_bytes !=
-        _size) { // We got less bytes than expected: reduce the vector's size.
-        res->resize(read_bytes);
-    }
-
-END:
-    if (f != nullptr) {
-        fclose(f);
     }
-    return res;
+    return boost::make_shared<std::vector<boost::uint8_t>>();
 }
 
 // ----------------------------------------------------------------------------
 
-bool parse_version_info_header(vs_version_info_header &header, FILE *f) {
+bool parse_version_info_header(vs_version_info_header &header, FileCursor &cursor) {
     memset(&header, 0, 3 * sizeof(boost::uint16_t));
-    if (3 * sizeof(boost::uint16_t) !=
-        fread(&header, 1, 3 * sizeof(boost::uint16_t), f)) {
+    if (!cursor.read_le(header.Length) || !cursor.read_le(header.ValueLength) ||
+        !cursor.read_le(header.Type)) {
         PRINT_ERROR << "Could not read a VS_VERSION_INFO header!" << DEBUG_INFO
                     << std::endl;
         return false;
     }
-    header.Key = utils::read_unicode_string(f);
-    unsigned int padding = ftell(f) % 4; // Next structure is 4-bytes aligned
-    return !fseek(f, padding, SEEK_CUR);
+    header.Key = utils::read_unicode_string(cursor);
+    unsigned int padding = cursor.tell() % 4; // Next structure is 4-bytes aligned
+    return cursor.skip(padding);
 }
 
 // ----------------------------------------------------------------------------
@@ -359,57 +367,75 @@ template <> DECLSPEC_MANAPE const_shared_strings Resource::interpret_as() {
         return res;
     }
 
-    FILE *f = _reach_data();
-    if (f == nullptr) {
-        goto END;
+    auto cursor = _reach_data();
+    if (!cursor) {
+        return res;
     }
 
     // RT_STRING resources are made of 16 contiguous "unicode" strings.
     for (int i = 0; i < 16; ++i) {
-        res->push_back(utils::read_prefixed_unicode_string(f));
-        std::vector<boost::uint8_t> utf8result;
-    }
-
-END:
-    if (f != nullptr) {
-        fclose(f);
+        res->push_back(utils::read_prefixed_unicode_string(*cursor));
     }
     return res;
 }
 
 // ----------------------------------------------------------------------------
 
-template <> DECLSPEC_MANAPE pbitmap Resource::interpret_as() {
-    if (_type != "RT_BITMAP") {
-        return pbitmap();
-    }
+namespace {
 
-    auto res = boost::make_shared<bitmap>();
-    unsigned int header_size = 14;
-    res->Magic[0] = 'B';
-    res->Magic[1] = 'M';
-    res->Reserved1 = 0;
-    res->Reserved2 = 0;
-    res->data = *get_raw_data();
-    res->Size = res->data.size() + header_size;
+// The size of the BITMAPFILEHEADER, which bitmaps stored as resources don't have.
+const unsigned int BITMAP_HEADER_SIZE = 14;
 
-    // Calculate the offset to the raw data.
-    if (res->data.size() < 36) { // Not enough bytes to make a valid BMP
-        return pbitmap();
+/**
+ *	@brief	Computes the fields of the BITMAPFILEHEADER missing from an RT_BITMAP.
+ *
+ *	@param	const ByteView& dib The bytes of the resource, which start with a DIB header.
+ *	@param	boost::uint32_t& size Receives the size of the complete BMP file.
+ *	@param	boost::uint32_t& offset_to_data Receives the offset of the pixels in the file.
+ *
+ *	@return	Whether the resource is large enough to be a bitmap.
+ */
+bool compute_bitmap_header(const ByteView &dib, boost::uint32_t &size,
+                           boost::uint32_t &offset_to_data) {
+    if (dib.size() < 36) { // Not enough bytes to make a valid BMP
+        return false;
     }
     boost::uint32_t dib_header_size = 0;
     boost::uint32_t colors_used = 0;
     boost::uint16_t bit_count;
-    memcpy(&dib_header_size, &(res->data[0]),
+    memcpy(&dib_header_size, dib.data(),
            sizeof(boost::uint32_t)); // DIB header size is located at offset 0.
-    memcpy(&bit_count, &(res->data[14]), sizeof(boost::uint16_t));
-    memcpy(&colors_used, &(res->data[32]), sizeof(boost::uint32_t));
+    memcpy(&bit_count, dib.data() + 14, sizeof(boost::uint16_t));
+    memcpy(&colors_used, dib.data() + 32, sizeof(boost::uint32_t));
 
     if (colors_used == 0 && bit_count != 32 && bit_count != 24) {
         colors_used = 1 << bit_count;
     }
 
-    res->OffsetToData = header_size + dib_header_size + 4 * colors_used;
+    size = static_cast<boost::uint32_t>(dib.size() + BITMAP_HEADER_SIZE);
+    offset_to_data = BITMAP_HEADER_SIZE + dib_header_size + 4 * colors_used;
+    return true;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+template <> DECLSPEC_MANAPE pbitmap Resource::interpret_as() {
+    if (_type != "RT_BITMAP") {
+        return pbitmap();
+    }
+
+    auto res = boost::make_shared<bitmap>();
+    ByteView dib = get_raw_view();
+    if (!compute_bitmap_header(dib, res->Size, res->OffsetToData)) {
+        return pbitmap();
+    }
+    res->Magic[0] = 'B';
+    res->Magic[1] = 'M';
+    res->Reserved1 = 0;
+    res->Reserved2 = 0;
+    res->data.assign(dib.begin(), dib.end());
     return res;
 }
 
@@ -419,16 +445,15 @@ template <> DECLSPEC_MANAPE pgroup_icon_directory Resource::interpret_as() {
     if (_type != "RT_GROUP_ICON" && _type != "RT_GROUP_CURSOR") {
         return pgroup_icon_directory();
     }
-    FILE *f = _reach_data();
-    if (f == nullptr) {
+    auto cursor = _reach_data();
+    if (!cursor) {
         return pgroup_icon_directory();
     }
 
     auto res = boost::make_shared<group_icon_directory>();
-    unsigned int size = sizeof(boost::uint16_t) * 3;
-    if (size != fread(res.get(), 1, size, f)) {
-        res.reset();
-        goto END;
+    if (!cursor->read_le(res->Reserved) || !cursor->read_le(res->Type) ||
+        !cursor->read_le(res->Count)) {
+        return pgroup_icon_directory();
     }
 
     for (unsigned int i = 0; i < res->Count; ++i) {
@@ -441,33 +466,26 @@ template <> DECLSPEC_MANAPE pgroup_icon_directory Resource::interpret_as() {
             // changed to boost::uint32. See the comment in the structure for more
             // information.
             if (sizeof(group_icon_directory_entry) - 2 !=
-                fread(entry.get(), 1, sizeof(group_icon_directory_entry) - 2, f)) {
-                res.reset();
-                goto END;
+                cursor->read(entry.get(), sizeof(group_icon_directory_entry) - 2)) {
+                return pgroup_icon_directory();
             }
         } else // Cursors have a different structure. Adapt it to a .ico.
         {
-            fread(&(entry->Width), 1, sizeof(boost::uint8_t), f);
-            fseek(f, 1, SEEK_CUR);
-            fread(&(entry->Height), 1, sizeof(boost::uint8_t), f);
+            bool success = cursor->read_le(entry->Width) && cursor->skip(1) &&
+                           cursor->read_le(entry->Height) && cursor->skip(1) &&
+                           cursor->read_le(entry->Planes) &&
+                           cursor->read_le(entry->BitCount) &&
+                           cursor->read_le(entry->BytesInRes) &&
+                           cursor->read_le(entry->Id, 2);
+            if (!success) {
+                return pgroup_icon_directory();
+            }
             entry->Height /=
                 2; // For some reason, twice the actual height is stored here.
-            fseek(f, 1, SEEK_CUR);
-            fread(&(entry->Planes), 1, sizeof(boost::uint16_t), f);
-            fread(&(entry->BitCount), 1, sizeof(boost::uint16_t), f);
-            fread(&(entry->BytesInRes), 1, sizeof(boost::uint32_t), f);
-            fread(&(entry->Id), 1, sizeof(boost::uint16_t), f);
-            if (ferror(f) || feof(f)) {
-                res.reset();
-                goto END;
-            }
         }
 
         res->Entries.push_back(entry);
     }
-
-END:
-    fclose(f);
     return res;
 }
 
@@ -478,13 +496,23 @@ template <> DECLSPEC_MANAPE pversion_info Resource::interpret_as() {
         return pversion_info();
     }
 
-    FILE *f = _reach_data();
-    if (f == nullptr) {
+    // The summary, the version info dump and some plugins all look at this resource:
+    // only parse it the first time.
+    std::call_once(_version_info_parsed,
+                   [this]() { _version_info = _parse_version_info(); });
+    return _version_info;
+}
+
+// ----------------------------------------------------------------------------
+
+pversion_info Resource::_parse_version_info() const {
+    auto cursor = _reach_data();
+    if (!cursor) {
         return pversion_info();
     }
 
     auto res = boost::make_shared<version_info>();
-    unsigned int bytes_read; // Is calculated by calling ftell before and after reading a
+    unsigned int bytes_read; // Is calculated by calling tell before and after reading a
                              // structure, and keeping the difference.
     unsigned int bytes_remaining;
     unsigned int language;
@@ -492,56 +520,50 @@ template <> DECLSPEC_MANAPE pversion_info Resource::interpret_as() {
 
     // We are going to read a lot of structures which look like a version info header.
     // They will all be read into this variable, one at a time.
-    auto current_structure = boost::make_shared<vs_version_info_header>();
-    if (!parse_version_info_header(res->Header, f)) {
-        res.reset();
-        goto END;
+    vs_version_info_header current_structure;
+    if (!parse_version_info_header(res->Header, *cursor)) {
+        return pversion_info();
     }
     res->Value = boost::make_shared<fixed_file_info>();
     memset(res->Value.get(), 0, sizeof(fixed_file_info));
 
     // 0xFEEF04BD is a magic located at the beginning of the VS_FIXED_FILE_INFO structure.
     if (sizeof(fixed_file_info) !=
-            fread(res->Value.get(), 1, sizeof(fixed_file_info), f) ||
+            cursor->read(res->Value.get(), sizeof(fixed_file_info)) ||
         res->Value->Signature != 0xfeef'04bd) {
         PRINT_ERROR << "Could not read a VS_FIXED_FILE_INFO!" << DEBUG_INFO << std::endl;
-        res.reset();
-        goto END;
+        return pversion_info();
     }
 
-    bytes_read = ftell(f);
-    if (!parse_version_info_header(*current_structure, f)) {
-        res.reset();
-        goto END;
+    bytes_read = cursor->tell();
+    if (!parse_version_info_header(current_structure, *cursor)) {
+        return pversion_info();
     }
 
     // This (uninteresting) VAR_FILE_INFO structure may be located before the
     // STRING_FILE_INFO we're after. In this case, just skip it.
-    if (current_structure->Key == "VarFileInfo") {
-        bytes_read = ftell(f) - bytes_read;
-        fseek(f, current_structure->Length - bytes_read, SEEK_CUR);
-        if (!parse_version_info_header(*current_structure, f)) {
-            res.reset();
-            goto END;
+    if (current_structure.Key == "VarFileInfo") {
+        bytes_read = cursor->tell() - bytes_read;
+        if (!cursor->skip(current_structure.Length - bytes_read) ||
+            !parse_version_info_header(current_structure, *cursor)) {
+            return pversion_info();
         }
     }
 
-    if (current_structure->Key != "StringFileInfo") {
-        PRINT_ERROR << "StringFileInfo expected, read " << current_structure->Key
+    if (current_structure.Key != "StringFileInfo") {
+        PRINT_ERROR << "StringFileInfo expected, read " << current_structure.Key
                     << " instead." << DEBUG_INFO << std::endl;
-        res.reset();
-        goto END;
+        return pversion_info();
     }
 
     // We don't need the contents of StringFileInfo. Replace them with the next structure.
-    bytes_read = ftell(f);
-    if (!parse_version_info_header(*current_structure, f)) {
-        res.reset();
-        goto END;
+    bytes_read = cursor->tell();
+    if (!parse_version_info_header(current_structure, *cursor)) {
+        return pversion_info();
     }
 
     // In the file, the language information is an int stored into a "unicode" string.
-    ss << std::hex << current_structure->Key;
+    ss << std::hex << current_structure.Key;
     ss >> language;
     if (!ss.fail()) {
         res->Language = *nt::translate_to_flag((language >> 16) & 0xFFFF, nt::LANG_IDS);
@@ -551,46 +573,46 @@ template <> DECLSPEC_MANAPE pversion_info Resource::interpret_as() {
         res->Language = "UNKNOWN";
     }
 
-    bytes_read = ftell(f) - bytes_read;
-    if (current_structure->Length < bytes_read) {
+    bytes_read = cursor->tell() - bytes_read;
+    if (current_structure.Length < bytes_read) {
         PRINT_ERROR << "The StringTableInfo has an invalid size." << DEBUG_INFO
                     << std::endl;
-        res.reset();
-        goto END;
+        return pversion_info();
     }
-    bytes_remaining = current_structure->Length - bytes_read;
+    bytes_remaining = current_structure.Length - bytes_read;
 
     // Read the StringTable
     while (bytes_remaining > 0) {
-        unsigned int current_offset = ftell(f);
-        if (!parse_version_info_header(*current_structure, f)) {
-            res.reset();
-            goto END;
+        unsigned int current_offset = cursor->tell();
+        if (!parse_version_info_header(current_structure, *cursor)) {
+            return pversion_info();
         }
 
         // Structures are aligned on DWORD boundaries, but the Length field doesn't
         // reflect that. Update it here to facilitate the parsing.
-        if (current_structure->Length % 4 != 0) {
-            current_structure->Length += 4 - current_structure->Length % 4;
+        if (current_structure.Length % 4 != 0) {
+            current_structure.Length += 4 - current_structure.Length % 4;
         }
 
         // Only process structures that contain data.
-        if (current_structure->ValueLength != 0) {
+        if (current_structure.ValueLength != 0) {
             std::string value;
-            if (ftell(f) - current_offset < current_structure->Length) {
-                value = utils::read_unicode_string(f);
+            if (cursor->tell() - current_offset < current_structure.Length) {
+                value = utils::read_unicode_string(*cursor);
             }
             // Add the key/value to our internal representation
-            auto p = boost::make_shared<string_pair>(current_structure->Key, value);
+            auto p = boost::make_shared<string_pair>(current_structure.Key, value);
             res->StringTable.push_back(p);
         }
 
-        if (current_structure->Length > 0 &&
-            current_structure->Length < bytes_remaining) {
-            bytes_remaining -= current_structure->Length;
+        if (current_structure.Length > 0 &&
+            current_structure.Length < bytes_remaining) {
+            bytes_remaining -= current_structure.Length;
             unsigned int next_structure_offset =
-                current_offset + current_structure->Length;
-            fseek(f, next_structure_offset, SEEK_SET);
+                current_offset + current_structure.Length;
+            if (!cursor->seek(next_structure_offset)) {
+                return pversion_info();
+            }
         } else {
             bytes_remaining = 0;
         }
@@ -602,9 +624,6 @@ template <> DECLSPEC_MANAPE pversion_info Resource::interpret_as() {
        my interests, and supporting it would increase the complexity of the version_info
        structure. If you *absolutely* need this for some reason, let me know.
     */
-
-END:
-    fclose(f);
     return res;
 }
 
@@ -616,215 +635,236 @@ template <> DECLSPEC_MANAPE shared_bytes Resource::interpret_as() {
 
 // ----------------------------------------------------------------------------
 
-FILE *Resource::_reach_data() const {
-    FILE *f = fopen(_path_to_pe.c_str(), "rb");
-    if (f == nullptr) { // File has moved, or is already in use.
-        return nullptr;
+boost::optional<FileCursor> Resource::_reach_data() const {
+    if (_file == nullptr) {
+        return boost::none;
     }
 
-    if (!_offset_in_file || fseek(f, _offset_in_file, SEEK_SET)) {
-        // Offset is invalid
-        fclose(f);
-        return nullptr;
+    // The cursor is restricted to the resource's bytes: interpret_as cannot read into
+    // whatever follows it, even if its structures are malformed.
+    FileCursor cursor = FileCursor(_file).subrange(_offset_in_file, _size);
+    if (!_offset_in_file || cursor.eof()) { // Offset is invalid
+        return boost::none;
     }
+    return cursor;
+}
+
+// ----------------------------------------------------------------------------
 
-    return f;
+IconIndex::IconIndex(const std::vector<pResource> &resources)
+    : _resource_count(resources.size()) {
+    for (const auto &r : resources) {
+        boost::uint16_t type;
+        if (*r->get_type() == "RT_ICON") {
+            type = 1;
+        } else if (*r->get_type() == "RT_CURSOR") {
+            type = 2;
+        } else {
+            continue;
+        }
+        // There can be duplicate IDs: like the linear search this replaces, keep the
+        // first resource.
+        _index.emplace(_make_key(type, r->get_id()), r);
+    }
 }
 
 // ----------------------------------------------------------------------------
 
-shared_bytes reconstruct_icon(pgroup_icon_directory directory,
-                                    const std::vector<pResource> &resources) {
-    std::vector<boost::uint8_t> res;
+pResource IconIndex::find(boost::uint16_t type, boost::uint32_t id) const {
+    auto it = _index.find(_make_key(type, id));
+    return it == _index.end() ? pResource() : it->second;
+}
+
+// ----------------------------------------------------------------------------
 
+namespace {
+
+/**
+ *	@brief	Prepares the reconstruction of a .ico: builds its header and locates the
+ *			image data, which stays in the mapped file.
+ *
+ *	@param	pgroup_icon_directory directory The RT_GROUP_ICON or RT_GROUP_CURSOR to
+ *			recreate.
+ *	@param	const IconIndex& index The icons and cursors of the PE.
+ *	@param	std::vector<boost::uint8_t>& header Receives the ICONDIR and its entries.
+ *	@param	std::vector<ByteView>& images Receives the image data, in the order in which
+ *			it follows the header in the .ico.
+ *
+ *	@return	Whether the icon could be reconstructed.
+ */
+bool gather_icon(const pgroup_icon_directory &directory, const IconIndex &index,
+                 std::vector<boost::uint8_t> &header, std::vector<ByteView> &images) {
     if (directory == nullptr) {
-        return shared_bytes();
+        return false;
     }
 
     // Sanity check.
-    if (directory->Count > resources.size()) {
+    if (directory->Count > index.get_resource_count() ||
+        directory->Count > directory->Entries.size()) {
         PRINT_ERROR << "The number of ICON_DIRECTORY_ENTRIES is bigger than the number "
                        "of resources in the file."
                     << DEBUG_INFO << std::endl;
-        return shared_bytes();
+        return false;
     }
 
-    boost::uint32_t header_size = 3 * sizeof(boost::uint16_t) +
-                                  directory->Count * sizeof(group_icon_directory_entry);
-    try {
-        res.resize(header_size);
-    } catch (const std::bad_alloc) {
-        PRINT_ERROR << "Could not allocate enough memory to reconstruct an icon. This PE "
-                       "may have been manually modified."
-                    << DEBUG_INFO << std::endl;
-        return shared_bytes();
-    }
-    memcpy(&res[0], directory.get(), 3 * sizeof(boost::uint16_t));
-
-    for (int i = 0; i < directory->Count; ++i) {
-        // Locate the RT_ICON with a matching ID.
-        pResource icon = pResource();
-        for (auto it = resources.begin(); it != resources.end(); ++it) {
-            auto type = (*it)->get_type();
-            // Because there can be duplicate resource IDs, only consider the ones
-            // exhibiting the right type.
-            if ((*it)->get_id() == directory->Entries[i]->Id && type &&
-                ((*type == "RT_ICON" && directory->Type == 1) ||
-                 (*type == "RT_CURSOR" && directory->Type == 2))) {
-                icon = *it;
-                break;
-            }
-        }
+    const size_t entries_offset = 3 * sizeof(boost::uint16_t);
+    header.resize(entries_offset + directory->Count * sizeof(group_icon_directory_entry));
+    memcpy(&header[0], directory.get(), entries_offset);
+    images.reserve(directory->Count);
+
+    boost::uint32_t file_size = static_cast<boost::uint32_t>(header.size());
+    for (unsigned int i = 0; i < directory->Count; ++i) {
+        const auto &entry = directory->Entries[i];
+        pResource icon = index.find(directory->Type, entry->Id);
         if (icon == nullptr) {
-            PRINT_ERROR << "Could not locate RT_ICON with ID "
-                        << directory->Entries[i]->Id << "!" << DEBUG_INFO << std::endl;
-            return shared_bytes();
+            PRINT_ERROR << "Could not locate RT_ICON with ID " << entry->Id << "!"
+                        << DEBUG_INFO << std::endl;
+            return false;
         }
 
-        shared_bytes icon_bytes = icon->get_raw_data();
-        memcpy(&res[3 * sizeof(boost::uint16_t) + i * sizeof(group_icon_directory_entry)],
-               directory->Entries[i].get(),
-               sizeof(group_icon_directory_entry) -
-                   sizeof(boost::uint32_t)); // Don't copy the last field.
-        // Fix the icon_directory_entry with the offset in the file instead of a RT_ICON
-        // id
-        size_t size_fix = res.size();
-        memcpy(
-            &res[3 * sizeof(boost::uint16_t) +
-                 (i + 1) * sizeof(group_icon_directory_entry) - sizeof(boost::uint32_t)],
-            &size_fix, sizeof(boost::uint32_t));
-        // Append the icon bytes at the end of the data
+        // Copy the entry, but replace the RT_ICON id (last field) with the offset of the
+        // image in the .ico.
+        const size_t id_offset =
+            sizeof(group_icon_directory_entry) - sizeof(boost::uint32_t);
+        boost::uint8_t *out =
+            &header[entries_offset + i * sizeof(group_icon_directory_entry)];
+        memcpy(out, entry.get(), id_offset);
+        memcpy(out + id_offset, &file_size, sizeof(boost::uint32_t));
+
+        ByteView icon_bytes = icon->get_raw_view();
         if (directory->Type == 1) { // General case for icons
-            res.insert(res.end(), icon_bytes->begin(), icon_bytes->end());
-        } else if (icon_bytes->size() > 4 &&
-                   directory->Entries[i]->BytesInRes >
-                       4) // Cursors have a "hotspot" structure that we have to discard to
-                          // create a valid ico.
-        {
-            res.insert(res.end(), icon_bytes->begin() + 2 * sizeof(boost::uint16_t),
-                       icon_bytes->end());
+            images.push_back(icon_bytes);
+        }
+        // Cursors have a "hotspot" structure that we have to discard to create a valid
+        // ico.
+        else if (icon_bytes.size() > 4 && entry->BytesInRes > 4) {
+            images.push_back(icon_bytes.subview(4, icon_bytes.size() - 4));
             // Remove 4 from the size to account for this suppression
-            int new_size = directory->Entries[i]->BytesInRes - 4;
-            memcpy(&res[3 * sizeof(boost::uint16_t) +
-                        i * sizeof(group_icon_directory_entry) + 8],
-                   &new_size, 4);
+            boost::uint32_t new_size = entry->BytesInRes - 4;
+            memcpy(out + 8, &new_size, sizeof(boost::uint32_t));
         } else { // Invalid cursor.
-            res.clear();
+            return false;
         }
+        file_size += static_cast<boost::uint32_t>(images.back().size());
     }
-
-    return boost::make_shared<std::vector<boost::uint8_t>>(res);
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
 /**
- * @brief   Function which writes bytes to a given file. Created to prevent code
- * duplication between extract and icon_extract.
- *
- * @param   const boost::filesystem::path& destination The path to the file to write.
- * @param   std::vector<boost::uint8_t> data The data to write.
- *
- * @return  Whether the file creation succeeded.
+ * @brief   Creates a view over bytes built in memory (i.e. a reconstructed header), so
+ * that they can be written along with views of the PE.
  */
-bool write_data_to_file(const boost::filesystem::path &destination,
-                        std::vector<boost::uint8_t> data) {
-    if (data.size() == 0) {
-        return true;
-    }
+ByteView make_view(shared_bytes bytes) {
+    boost::uint64_t size = bytes->size();
+    return ByteView(FileBuffer::from_memory(std::move(bytes)), 0, size);
+}
 
-    FILE *f = fopen(destination.string().c_str(), "wb+");
-    if (f == nullptr) {
-        PRINT_ERROR << "Could not open " << destination.string() << "." << DEBUG_INFO
-                    << std::endl;
-        return false;
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+shared_bytes reconstruct_icon(pgroup_icon_directory directory, const IconIndex &index) {
+    auto res = boost::make_shared<std::vector<boost::uint8_t>>();
+    std::vector<ByteView> images;
+    if (!gather_icon(directory, index, *res, images)) {
+        return shared_bytes();
     }
-    if (data.size() != fwrite(&data[0], 1, data.size(), f)) {
-        fclose(f);
-        PRINT_ERROR << "Could not write all the bytes for " << destination.string() << "."
-                    << DEBUG_INFO << std::endl;
-        return false;
+    for (const auto &image : images) {
+        res->insert(res->end(), image.begin(), image.end());
     }
+    return res;
+}
 
-    fclose(f);
-    return true;
+// ----------------------------------------------------------------------------
+
+shared_bytes reconstruct_icon(pgroup_icon_directory directory,
+                              const std::vector<pResource> &resources) {
+    return reconstruct_icon(directory, IconIndex(resources));
 }
 
+
 // ----------------------------------------------------------------------------
 
 bool Resource::extract(const boost::filesystem::path &destination) {
-    shared_bytes data;
+    // The resource's bytes are not loaded: write_to_file copies them straight from the
+    // PE to the destination.
+    std::vector<ByteView> views;
     if (_type == "RT_GROUP_ICON" || _type == "RT_GROUP_CURSOR") {
         PRINT_WARNING << "Use icon_extract to properly recreate icons." << std::endl;
-        data = get_raw_data();
+        views.push_back(get_raw_view());
     } else if (_type == "RT_BITMAP") {
-        unsigned int header_size = 2 * sizeof(boost::uint8_t) +
-                                   2 * sizeof(boost::uint16_t) +
-                                   2 * sizeof(boost::uint32_t);
-        auto bmp = interpret_as<pbitmap>();
-        if (bmp == nullptr) {
+        // Write the BMP header, followed by the image bytes.
+        ByteView dib = get_raw_view();
+        boost::uint32_t size = 0, offset_to_data = 0;
+        if (!compute_bitmap_header(dib, size, offset_to_data)) {
             PRINT_ERROR << "Bitmap " << _name << " is malformed!" << std::endl;
             return false;
         }
-
-        // Copy the BMP header
-        boost::shared_ptr<std::vector<boost::uint8_t>> bmp_bytes(
-            new std::vector<boost::uint8_t>(header_size));
-        memcpy(&bmp_bytes->at(0), bmp.get(), header_size);
-        // Copy the image bytes.
-        bmp_bytes->insert(bmp_bytes->end(), bmp->data.begin(), bmp->data.end());
-        data = bmp_bytes;
+        boost::uint8_t header[BITMAP_HEADER_SIZE] = {'B', 'M'}; // Reserved fields are 0.
+        memcpy(header + 2, &size, sizeof(size));
+        memcpy(header + 10, &offset_to_data, sizeof(offset_to_data));
+
+        // The header only has to outlive the call to write_to_file.
+        views.push_back(
+            ByteView(FileBuffer::from_memory(header, sizeof(header)), 0, sizeof(header)));
+        views.push_back(dib);
     } else if (_type == "RT_STRING") {
-        // RT_STRINGs are written immediately to the file instead of trying to reconstruct
-        // an original byte stream.
+        // The strings of all the RT_STRING resources are appended to the same file
+        // instead of trying to reconstruct an original byte stream.
         auto strings = interpret_as<const_shared_strings>();
-        if (strings->size() == 0) {
-            return true;
-        }
-
-        FILE *out = fopen(destination.string().c_str(), "a+");
-
-        if (out == nullptr) {
-            PRINT_ERROR << "Opening file " << destination.string().c_str() << " failed!"
-                        << std::endl;
-            return false;
-        }
-
+        auto lines = boost::make_shared<std::vector<boost::uint8_t>>();
         for (auto it2 = strings->begin(); it2 != strings->end(); ++it2) {
             if (*it2 != "") {
-                fwrite(it2->c_str(), it2->size(), 1, out);
-                fwrite("\n", 1, 1, out);
+                lines->insert(lines->end(), it2->begin(), it2->end());
+                lines->push_back('\n');
             }
         }
-        fclose(out);
-        return true;
+        if (lines->empty()) {
+            return true;
+        }
+        return write_to_file(destination, std::vector<ByteView>(1, make_view(lines)),
+                             true);
     } else {
-        data = get_raw_data();
+        views.push_back(get_raw_view());
     }
 
-    if (data == nullptr || data->size() == 0) {
+    if (views.back().empty()) {
         PRINT_WARNING << "Resource " << _name << " is empty!" << DEBUG_INFO << std::endl;
         return true;
     }
 
-    return write_data_to_file(destination, *data);
+    return write_to_file(destination, views);
 }
 
 // ----------------------------------------------------------------------------
 
 bool Resource::icon_extract(const boost::filesystem::path &destination,
-                            const std::vector<pResource> &resources) {
+                            const IconIndex &index) {
     if (_type != "RT_GROUP_ICON" && _type != "RT_GROUP_CURSOR") {
         PRINT_WARNING << "Called icon_extract on a non-icon resource!" << std::endl;
         return extract(destination);
     }
-    auto data = reconstruct_icon(interpret_as<pgroup_icon_directory>(), resources);
-    if (!data || data->empty()) {
+
+    // Only the header is built in memory: the images are copied straight from the PE
+    // into the destination.
+    auto header = boost::make_shared<std::vector<boost::uint8_t>>();
+    std::vector<ByteView> images;
+    if (!gather_icon(interpret_as<pgroup_icon_directory>(), index, *header, images)) {
         PRINT_WARNING << "Resource " << _id << " is empty!" << DEBUG_INFO << std::endl;
         return true;
     }
 
-    return write_data_to_file(destination, *data);
+    images.insert(images.begin(), make_view(header));
+    return write_to_file(destination, images);
+}
+
+// ----------------------------------------------------------------------------
+
+bool Resource::icon_extract(const boost::filesystem::path &destination,
+                            const std::vector<pResource> &resources) {
+    return icon_extract(destination, IconIndex(resources));
 }
 
 } // namespace mana::pe
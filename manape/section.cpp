@@ -15,14 +15,18 @@ You should have received a copy of the GNU General Public License
 along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cstring>
+#include <set>
+
 #include "manacommons/color.h"
 #include "manacommons/escape.h"
 #include "manape/section.h"
 
 namespace mana::pe {
 
-Section::Section(const image_section_header &header, pFile handle,
-                 boost::uint64_t file_size, const std::vector<pString> &coff_string_table)
+Section::Section(const image_section_header &header, pFileBuffer file,
+                 boost::uint64_t file_size, const ByteView &coff_string_table)
     : _virtual_size(header.VirtualSize), _virtual_address(header.VirtualAddress),
       _size_of_raw_data(header.SizeOfRawData),
       _pointer_to_raw_data(header.PointerToRawData),
@@ -30,7 +34,7 @@ Section::Section(const image_section_header &header, pFile handle,
       _pointer_to_line_numbers(header.PointerToLineNumbers),
       _number_of_relocations(header.NumberOfRelocations),
       _number_of_line_numbers(header.NumberOfLineNumbers),
-      _characteristics(header.Characteristics), _file_handle(std::move(handle)),
+      _characteristics(header.Characteristics), _file(std::move(file)),
       _file_size(file_size) {
     _name = std::string((char *)header.Name, 8);
     boost::trim_right_if(
@@ -58,49 +62,48 @@ Section::Section(const image_section_header &header, pFile handle,
                              "name of section "
                           << _name << "!" << std::endl;
         } else {
-            _name = *coff_string_table[index];
+            // The index is an offset into the table. Names are null-terminated, unless
+            // the table is truncated.
+            auto begin = reinterpret_cast<const char *>(coff_string_table.data()) + index;
+            auto end = static_cast<const char *>(
+                memchr(begin, 0, coff_string_table.size() - index));
+            _name = std::string(begin, end == nullptr ? coff_string_table.size() - index
+                                                      : end - begin);
         }
     }
 }
 
 // ----------------------------------------------------------------------------
 
-shared_bytes Section::get_raw_data() const {
-    auto res = boost::make_shared<std::vector<boost::uint8_t>>();
+ByteView Section::get_raw_view() const {
     if (_size_of_raw_data == 0) {
         PRINT_WARNING << "Section " << _name << " has a size of 0!" << DEBUG_INFO
                       << std::endl;
-        return res;
+        return ByteView();
     }
-    if (_file_handle == nullptr) {
-        return res;
+    if (_file == nullptr) {
+        return ByteView();
     }
-    if (_pointer_to_raw_data + _size_of_raw_data > _file_size) {
+    if (static_cast<boost::uint64_t>(_pointer_to_raw_data) + _size_of_raw_data >
+        _file_size) {
         PRINT_WARNING << "Section " << _name << " is larger than the executable!"
                       << DEBUG_INFO << std::endl;
-        return res;
-    }
-    if (fseek(_file_handle.get(), _pointer_to_raw_data, SEEK_SET)) {
-        return res;
+        return ByteView();
     }
+    return ByteView(_file, _pointer_to_raw_data, _size_of_raw_data);
+}
 
+// ----------------------------------------------------------------------------
+
+shared_bytes Section::get_raw_data() const {
+    ByteView view = get_raw_view();
     try {
-        res->resize(_size_of_raw_data);
+        return view.to_vector();
     } catch (const std::exception &e) {
         PRINT_ERROR << "Failed to allocate enough space for section " << *get_name()
                     << "! (" << e.what() << ")" << DEBUG_INFO << std::endl;
-        res->resize(0);
-        return res;
     }
-
-    if (_size_of_raw_data !=
-        fread(&(*res)[0], 1, _size_of_raw_data, _file_handle.get())) {
-        PRINT_WARNING << "Raw bytes from section " << _name << " could not be obtained."
-                      << std::endl;
-        res->resize(0);
-    }
-
-    return res;
+    return boost::make_shared<std::vector<boost::uint8_t>>();
 }
 
 // ----------------------------------------------------------------------------
@@ -139,4 +142,86 @@ pSection find_section(unsigned int rva, const std::vector<pSection> &section_lis
     return res;
 }
 
+// ----------------------------------------------------------------------------
+
+SectionIndex::SectionIndex(const std::vector<pSection> &sections) : _last_hit(0) {
+    // Each section starts and stops covering the address space twice: once according
+    // to its VirtualSize, and once according to its SizeOfRawData (used as a fallback).
+    struct bound {
+        boost::uint64_t address;
+        bool is_end;
+        bool raw;
+        size_t index;
+    };
+    std::vector<bound> bounds;
+    bounds.reserve(sections.size() * 4);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i] == nullptr) {
+            continue;
+        }
+        // Same arithmetic as is_address_in_section: ends are computed on 32 bits, and
+        // sections which wrap around do not contain any address.
+        boost::uint32_t start = sections[i]->get_virtual_address();
+        boost::uint32_t virtual_end = start + sections[i]->get_virtual_size();
+        boost::uint32_t raw_end = start + sections[i]->get_size_of_raw_data();
+        if (start < virtual_end) {
+            bounds.push_back({start, false, false, i});
+            bounds.push_back({virtual_end, true, false, i});
+        }
+        if (start < raw_end) {
+            bounds.push_back({start, false, true, i});
+            bounds.push_back({raw_end, true, true, i});
+        }
+    }
+    std::sort(bounds.begin(), bounds.end(), [](const bound &a, const bound &b) {
+        return a.address < b.address;
+    });
+
+    // Sweep the address space. When sections overlap, the first one in the section table
+    // wins, exactly like in find_section.
+    std::set<size_t> active[2]; // Sections covering the current range (virtual / raw).
+    for (size_t i = 0; i < bounds.size();) {
+        boost::uint64_t address = bounds[i].address;
+        for (; i < bounds.size() && bounds[i].address == address; ++i) {
+            auto &s = active[bounds[i].raw ? 1 : 0];
+            if (bounds[i].is_end) {
+                s.erase(bounds[i].index);
+            } else {
+                s.insert(bounds[i].index);
+            }
+        }
+
+        pSection owner;
+        if (!active[0].empty()) {
+            owner = sections[*active[0].begin()];
+        } else if (!active[1].empty()) {
+            owner = sections[*active[1].begin()];
+        }
+        if (!_owners.empty() && _owners.back() == owner) {
+            continue; // Merge with the previous range.
+        }
+        _starts.push_back(address);
+        _owners.push_back(owner);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+pSection SectionIndex::find(boost::uint64_t rva) const {
+    // Fast path: successive lookups tend to target the same section.
+    size_t hit = _last_hit.load(std::memory_order_relaxed);
+    if (hit < _starts.size() && _starts[hit] <= rva &&
+        (hit + 1 == _starts.size() || rva < _starts[hit + 1])) {
+        return _owners[hit];
+    }
+
+    auto it = std::upper_bound(_starts.begin(), _starts.end(), rva);
+    if (it == _starts.begin()) { // The address is located before the first section.
+        return pSection();
+    }
+    hit = std::distance(_starts.begin(), it) - 1;
+    _last_hit.store(hit, std::memory_order_relaxed);
+    return _owners[hit];
+}
+
 } // namespace mana::pe
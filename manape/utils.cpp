@@ -15,6 +15,27 @@
     along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MANAPE_SSE2 1
+#include <emmintrin.h>
+#endif
+// The AVX2 code is compiled in any case and only used if the CPU supports it.
+#if defined(MANAPE_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define MANAPE_AVX2 1
+#include <immintrin.h>
+#if defined(__GNUC__)
+#define MANAPE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MANAPE_TARGET_AVX2
+#endif
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "manape/utils.h"
 #include "manacommons/color.h"
 
@@ -23,21 +44,137 @@ namespace btime = boost::posix_time;
 
 namespace mana::utils {
 
+namespace {
+
+/**
+ *	@brief	Returns the index of the lowest bit set in a non-null integer.
+ */
+inline unsigned int lowest_bit_set(unsigned int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Looks for the null character terminating a UTF-16 string.
+ *
+ *	On x86 processors, eight characters are checked at a time.
+ *
+ *	@param	const boost::uint8_t* data The string's bytes. They do not need to be aligned.
+ *	@param	size_t count The number of UTF-16 characters available.
+ *
+ *	@return	The index of the first null character, or count if there is none.
+ */
+size_t find_utf16_terminator(const boost::uint8_t *data, size_t count) {
+    size_t i = 0;
+#if defined(MANAPE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 2 * i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, zero));
+        if (mask) {
+            return i + lowest_bit_set(mask) / 2;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        if (data[2 * i] == 0 && data[2 * i + 1] == 0) {
+            return i;
+        }
+    }
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Converts a UTF-16LE string into UTF-8.
+ *
+ *	The output is built in a single allocation, without going through an intermediate
+ *	std::wstring.
+ *
+ *	@param	const boost::uint8_t* data The string's bytes.
+ *	@param	size_t count The number of UTF-16 characters to convert.
+ *
+ *	@return	The UTF-8 string, or an empty string if the input contains unpaired
+ *			surrogates.
+ */
+std::string utf16_to_utf8(const boost::uint8_t *data, size_t count) {
+    std::string res;
+    res.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        boost::uint32_t cp = data[2 * i] | (data[2 * i + 1] << 8);
+        if (cp < 0x80) { // Fast path for ASCII, which most strings are made of.
+            res.push_back(static_cast<char>(cp));
+            continue;
+        }
+
+        bool valid = true;
+        if (cp >= 0xD800 && cp <= 0xDBFF) { // Lead surrogate
+            boost::uint32_t trail =
+                i + 1 < count ? data[2 * i + 2] | (data[2 * i + 3] << 8) : 0;
+            valid = trail >= 0xDC00 && trail <= 0xDFFF;
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (trail - 0xDC00);
+            ++i;
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) { // Unpaired trail surrogate
+            valid = false;
+        }
+
+        if (!valid) {
+            PRINT_WARNING << "Couldn't convert a string from a RT_STRING resource to UTF-8!"
+                          << DEBUG_INFO << std::endl;
+            return "";
+        } else if (cp < 0x800) {
+            res.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        } else if (cp < 0x10000) {
+            res.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            res.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        } else {
+            res.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            res.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            res.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        }
+        res.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    return res;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
 DECLSPEC_MANAPE std::string read_ascii_string(FILE *f, unsigned int max_bytes) {
     std::string s = std::string();
-    char c = 0;
-    while (1 == fread(&c, 1, 1, f)) {
-        if (c == '\0') {
+    char buffer[256];
+    while (max_bytes == 0 || s.size() < max_bytes) {
+        size_t to_read = sizeof(buffer);
+        if (max_bytes != 0) { // Already 0 if no limit.
+            to_read = std::min(to_read, max_bytes - s.size());
+        }
+        size_t read = fread(buffer, 1, to_read, f);
+        if (read == 0) {
             break;
         }
-        s += c;
-        if (max_bytes != 0) // Already 0 if no limit.
-        {
-            --max_bytes;
-            if (!max_bytes) { // <= Just in case someone thin
-                break;
-            }
+
+        const char *end = static_cast<const char *>(memchr(buffer, 0, read));
+        if (end == nullptr) {
+            s.append(buffer, read);
+            continue;
         }
+        s.append(buffer, end - buffer);
+
+        // Leave the file cursor right after the null terminator.
+        long unused = static_cast<long>(buffer + read - end - 1);
+        if (unused) {
+            fseek(f, -unused, SEEK_CUR);
+        }
+        break;
     }
     return s;
 }
@@ -45,66 +182,60 @@ DECLSPEC_MANAPE std::string read_ascii_string(FILE *f, unsigned int max_bytes) {
 // ----------------------------------------------------------------------------
 
 DECLSPEC_MANAPE std::string read_unicode_string(FILE *f, unsigned int max_bytes) {
-    std::wstring s = std::wstring();
-    wchar_t c = 0;
-    while (2 == fread(&c, 1, 2, f)) {
-        if (c == '\0') {
+    std::vector<boost::uint8_t> bytes;
+    boost::uint8_t buffer[512];
+    size_t max_chars = max_bytes / 2;
+    while (max_bytes == 0 || bytes.size() / 2 < max_chars) {
+        size_t to_read = sizeof(buffer);
+        if (max_bytes != 0) {
+            to_read = std::min(to_read, 2 * (max_chars - bytes.size() / 2));
+        }
+        size_t read = fread(buffer, 1, to_read, f) / 2;
+        if (read == 0) {
             break;
         }
-        s += c;
-        if (max_bytes != 0) // Already 0 if no limit.
-        {
-            max_bytes -= 2;
-            if (max_bytes <= 1) {
-                break;
+
+        size_t length = find_utf16_terminator(buffer, read);
+        bytes.insert(bytes.end(), buffer, buffer + 2 * length);
+        if (length < read) {
+            long unused = static_cast<long>(2 * (read - length - 1));
+            if (unused) {
+                fseek(f, -unused, SEEK_CUR);
             }
+            break;
         }
     }
-
-    try {
-        std::vector<boost::uint8_t> utf8result;
-        utf8::utf16to8(s.begin(), s.end(), std::back_inserter(utf8result));
-        return std::string(utf8result.begin(), utf8result.end());
-    } catch (utf8::invalid_utf16 &) {
-        PRINT_WARNING << "Couldn't convert a string from a RT_STRING resource to UTF-8!"
-                      << DEBUG_INFO << std::endl;
-    }
-    return "";
+    return bytes.empty() ? "" : utf16_to_utf8(&bytes[0], bytes.size() / 2);
 }
 
 // ----------------------------------------------------------------------------
 
 DECLSPEC_MANAPE std::wstring read_prefixed_unicode_wstring(FILE *f) {
-    std::wstring s = std::wstring();
-    wchar_t c = 0;
     boost::uint16_t size;
     if (2 != fread(&size, 1, 2, f)) {
         return L"";
     }
 
-    for (unsigned int i = 0; i < size; ++i) {
-        if (2 != fread(&c, 1, 2, f)) {
-            break;
-        }
-        s += c;
+    std::vector<boost::uint16_t> chars(size);
+    if (size) {
+        chars.resize(fread(&chars[0], 2, size, f));
     }
-    return s;
+    return std::wstring(chars.begin(), chars.end());
 }
 
 // ----------------------------------------------------------------------------
 
 DECLSPEC_MANAPE std::string read_prefixed_unicode_string(FILE *f) {
-    std::wstring s = read_prefixed_unicode_wstring(f);
+    boost::uint16_t size;
+    if (2 != fread(&size, 1, 2, f)) {
+        return "";
+    }
 
-    try {
-        std::vector<boost::uint8_t> utf8result;
-        utf8::utf16to8(s.begin(), s.end(), std::back_inserter(utf8result));
-        return std::string(utf8result.begin(), utf8result.end());
-    } catch (utf8::invalid_utf16 &) {
-        PRINT_WARNING << "Couldn't convert a string from a RT_STRING resource to UTF-8!"
-                      << DEBUG_INFO << std::endl;
+    std::vector<boost::uint8_t> bytes(2 * size);
+    if (size) {
+        bytes.resize(2 * fread(&bytes[0], 2, size, f));
     }
-    return "";
+    return bytes.empty() ? "" : utf16_to_utf8(&bytes[0], bytes.size() / 2);
 }
 
 // ----------------------------------------------------------------------------
@@ -127,20 +258,301 @@ DECLSPEC_MANAPE bool read_string_at_offset(FILE *f, unsigned int offset, std::st
 
 // ----------------------------------------------------------------------------
 
+DECLSPEC_MANAPE std::string read_ascii_string(pe::FileCursor &cursor,
+                                              unsigned int max_bytes) {
+    size_t available = static_cast<size_t>(
+        std::min<boost::uint64_t>(cursor.remaining(), std::numeric_limits<size_t>::max()));
+    if (max_bytes != 0) {
+        available = std::min<size_t>(available, max_bytes);
+    }
+    if (available == 0) {
+        return "";
+    }
+
+    // The string is read directly from the mapped file.
+    const char *start = reinterpret_cast<const char *>(cursor.data());
+    const char *end = static_cast<const char *>(memchr(start, 0, available));
+    if (end == nullptr) { // No terminator: everything available belongs to the string.
+        cursor.skip(available);
+        return std::string(start, available);
+    }
+    cursor.skip(end - start + 1);
+    return std::string(start, end);
+}
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE std::string read_unicode_string(pe::FileCursor &cursor,
+                                                unsigned int max_bytes) {
+    size_t available = static_cast<size_t>(
+        std::min<boost::uint64_t>(cursor.remaining(), std::numeric_limits<size_t>::max()));
+    if (max_bytes != 0) {
+        available = std::min<size_t>(available, max_bytes);
+    }
+    available /= 2; // Now a number of characters.
+    if (available == 0) {
+        return "";
+    }
+
+    const boost::uint8_t *start = cursor.data();
+    size_t length = find_utf16_terminator(start, available);
+    cursor.skip(2 * std::min(length + 1, available));
+    return utf16_to_utf8(start, length);
+}
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE std::wstring read_prefixed_unicode_wstring(pe::FileCursor &cursor) {
+    boost::uint16_t size;
+    if (!cursor.read_le(size)) {
+        return L"";
+    }
+
+    // Truncate the string if it goes past the end of the cursor.
+    std::vector<boost::uint16_t> chars;
+    cursor.read_array(chars, static_cast<size_t>(std::min<boost::uint64_t>(
+                                 size, cursor.remaining() / 2)));
+    return std::wstring(chars.begin(), chars.end());
+}
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE std::string read_prefixed_unicode_string(pe::FileCursor &cursor) {
+    boost::uint16_t size;
+    if (!cursor.read_le(size)) {
+        return "";
+    }
+
+    size_t length = static_cast<size_t>(
+        std::min<boost::uint64_t>(size, cursor.remaining() / 2));
+    const boost::uint8_t *start = cursor.data();
+    cursor.skip(2 * length);
+    return utf16_to_utf8(start, length);
+}
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE bool read_string_at_offset(const pe::FileCursor &cursor,
+                                           unsigned int offset, std::string &out,
+                                           bool unicode) {
+    pe::FileCursor string_cursor = cursor.at(offset);
+    if (string_cursor.eof()) {
+        PRINT_ERROR << "Could not reach offset 0x" << std::hex << offset << "."
+                    << std::endl;
+        return false;
+    }
+    if (!unicode) {
+        out = read_ascii_string(string_cursor);
+    } else {
+        out = read_prefixed_unicode_string(string_cursor);
+    }
+    return !out.empty();
+}
+
+// ----------------------------------------------------------------------------
+
 DECLSPEC_MANAPE double shannon_entropy(const std::vector<boost::uint8_t> &bytes) {
-    int frequency[256] = {0};
-    for (const auto &it : bytes) {
-        frequency[it] += 1;
+    return shannon_entropy(bytes.empty() ? nullptr : &bytes[0], bytes.size());
+}
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE size_t find_dword(const boost::uint8_t *data, size_t count,
+                                  boost::uint32_t value) {
+    size_t i = 0;
+#if defined(MANAPE_SSE2)
+    const __m128i needle = _mm_set1_epi32(static_cast<int>(value));
+    for (; i + 4 <= count; i += 4) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 4 * i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(chunk, needle));
+        if (mask) {
+            return i + lowest_bit_set(mask) / 4;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        const boost::uint8_t *p = data + 4 * i;
+        boost::uint32_t dword = p[0] | (p[1] << 8) | (p[2] << 16) |
+                                (static_cast<boost::uint32_t>(p[3]) << 24);
+        if (dword == value) {
+            return i;
+        }
+    }
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+
+// Each byte value has one counter per bank, and consecutive bytes are counted in
+// different banks. With a single table, a run of identical bytes would make every
+// increment wait for the previous one to be stored.
+const size_t HISTOGRAM_BANKS = 4;
+typedef boost::uint32_t histogram_banks[HISTOGRAM_BANKS][256];
+
+// The banks are flushed after this many bytes, before their counters can overflow.
+const size_t HISTOGRAM_BLOCK_SIZE = 1 << 24;
+
+// The SIMD kernels hand the bytes between uniform blocks to histogram_scalar in spans
+// of at most this size. Longer spans would be scanned from memory before being counted,
+// instead of both happening at the same time.
+const size_t HISTOGRAM_SPAN_SIZE = 512;
+
+typedef void (*histogram_kernel)(histogram_banks &, const boost::uint8_t *, size_t);
+
+void histogram_scalar(histogram_banks &banks, const boost::uint8_t *data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        boost::uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        ++banks[0][word & 0xFF];
+        ++banks[1][(word >> 8) & 0xFF];
+        ++banks[2][(word >> 16) & 0xFF];
+        ++banks[3][(word >> 24) & 0xFF];
+        ++banks[0][(word >> 32) & 0xFF];
+        ++banks[1][(word >> 40) & 0xFF];
+        ++banks[2][(word >> 48) & 0xFF];
+        ++banks[3][word >> 56];
+    }
+    for (; i < size; ++i) {
+        ++banks[i % HISTOGRAM_BANKS][data[i]];
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined(MANAPE_SSE2)
+/**
+ *	@brief	Looks for blocks of 16 bytes made of a single value.
+ *
+ *	Sections and resources contain long runs of padding. Uniform blocks are detected
+ *	with one comparison and counted at once. The bytes between them are handed to
+ *	histogram_scalar in spans of up to HISTOGRAM_SPAN_SIZE bytes, rather than one
+ *	block at a time.
+ */
+void histogram_sse2(histogram_banks &banks, const boost::uint8_t *data, size_t size) {
+    size_t span = 0; // Start of the bytes which haven't been counted yet.
+    for (size_t i = 0; i + 16 <= size; i += 16) {
+        if (i - span >= HISTOGRAM_SPAN_SIZE) {
+            histogram_scalar(banks, data + span, i - span);
+            span = i;
+        }
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i first = _mm_set1_epi8(static_cast<char>(data[i]));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, first)) == 0xFFFF) {
+            if (span < i) {
+                histogram_scalar(banks, data + span, i - span);
+            }
+            banks[0][data[i]] += 16;
+            span = i + 16;
+        }
+    }
+    histogram_scalar(banks, data + span, size - span);
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(MANAPE_AVX2)
+/**
+ *	@brief	The AVX2 version of histogram_sse2, which works on 32 bytes at a time.
+ */
+MANAPE_TARGET_AVX2
+void histogram_avx2(histogram_banks &banks, const boost::uint8_t *data, size_t size) {
+    size_t span = 0;
+    for (size_t i = 0; i + 32 <= size; i += 32) {
+        if (i - span >= HISTOGRAM_SPAN_SIZE) {
+            histogram_scalar(banks, data + span, i - span);
+            span = i;
+        }
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i first = _mm256_set1_epi8(static_cast<char>(data[i]));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, first)) == -1) {
+            if (span < i) {
+                histogram_scalar(banks, data + span, i - span);
+            }
+            banks[0][data[i]] += 32;
+            span = i + 32;
+        }
+    }
+    histogram_scalar(banks, data + span, size - span);
+}
+
+// ----------------------------------------------------------------------------
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // The OS must also save the YMM registers.
+    __cpuid(info, 1);
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+histogram_kernel select_histogram_kernel() {
+#if defined(MANAPE_AVX2)
+    if (cpu_has_avx2()) {
+        return histogram_avx2;
+    }
+#endif
+#if defined(MANAPE_SSE2)
+    return histogram_sse2;
+#else
+    return histogram_scalar;
+#endif
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE void byte_histogram(const boost::uint8_t *data, size_t size,
+                                    boost::uint64_t *histogram) {
+    static const histogram_kernel kernel = select_histogram_kernel();
+    memset(histogram, 0, 256 * sizeof(boost::uint64_t));
+    histogram_banks banks;
+    for (size_t offset = 0; offset < size; offset += HISTOGRAM_BLOCK_SIZE) {
+        memset(banks, 0, sizeof(banks));
+        kernel(banks, data + offset, std::min(HISTOGRAM_BLOCK_SIZE, size - offset));
+        for (const auto &bank : banks) {
+            for (int i = 0; i < 256; ++i) {
+                histogram[i] += bank[i];
+            }
+        }
     }
+}
+
+// ----------------------------------------------------------------------------
 
+DECLSPEC_MANAPE double shannon_entropy(const boost::uint8_t *data, size_t size) {
+    boost::uint64_t frequency[256];
+    byte_histogram(data, size, frequency);
+
+    static const double LOG_2 = log(2.);
     double res = 0.;
-    auto size = static_cast<double>(bytes.size());
+    auto total = static_cast<double>(size);
     for (int i = 0; i < 256; ++i) {
         if (frequency[i] == 0) {
             continue;
         }
-        double freq = static_cast<double>(frequency[i]) / size;
-        res -= freq * log(freq) / log(2.);
+        double freq = static_cast<double>(frequency[i]) / total;
+        res -= freq * log(freq) / LOG_2;
     }
 
     return res;
@@ -148,7 +560,107 @@ DECLSPEC_MANAPE double shannon_entropy(const std::vector<boost::uint8_t> &bytes)
 
 // ----------------------------------------------------------------------------
 
+namespace {
+
+const boost::int64_t SECONDS_PER_DAY = 86400;
+
+// The range of years supported by boost::gregorian, which format_timestamp mimics.
+const boost::int64_t MIN_TIMESTAMP = -17987443200; // 1400-Jan-01 00:00:00
+const boost::int64_t MAX_TIMESTAMP = 253402300799; // 9999-Dec-31 23:59:59
+
+/**
+ *	@brief	Returns the number of days between 1970-01-01 and a date of the proleptic
+ *			Gregorian calendar.
+ *
+ *	See http://howardhinnant.github.io/date_algorithms.html#days_from_civil.
+ */
+boost::int64_t days_from_civil(boost::int64_t y, unsigned int m, unsigned int d) {
+    y -= m <= 2;
+    const boost::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe = static_cast<unsigned int>(y - era * 400);
+    const unsigned int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<boost::int64_t>(doe) - 719468;
+}
+
+/**
+ *	@brief	The inverse of days_from_civil.
+ */
+void civil_from_days(boost::int64_t z, boost::int64_t &y, unsigned int &m,
+                     unsigned int &d) {
+    z += 719468;
+    const boost::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const auto doe = static_cast<unsigned int>(z - era * 146097);
+    const unsigned int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<boost::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+bool is_leap_year(unsigned int y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+/**
+ *	@brief	Writes a number on a fixed number of digits, padded with zeroes.
+ */
+char *write_digits(char *out, unsigned int value, unsigned int digits) {
+    for (unsigned int i = digits; i > 0; --i) {
+        out[i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + digits;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE bool format_timestamp(boost::int64_t timestamp, char *buffer) {
+    static const char *const MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    if (timestamp < MIN_TIMESTAMP || timestamp > MAX_TIMESTAMP) {
+        return false;
+    }
+
+    boost::int64_t days = timestamp / SECONDS_PER_DAY;
+    boost::int64_t seconds = timestamp % SECONDS_PER_DAY;
+    if (seconds < 0) {
+        seconds += SECONDS_PER_DAY;
+        --days;
+    }
+    boost::int64_t year;
+    unsigned int month, day;
+    civil_from_days(days, year, month, day);
+
+    // Same output as boost's "%Y-%b-%d %H:%M:%S" time_facet.
+    char *out = write_digits(buffer, static_cast<unsigned int>(year), 4);
+    *out++ = '-';
+    memcpy(out, MONTHS[month - 1], 3);
+    out += 3;
+    *out++ = '-';
+    out = write_digits(out, day, 2);
+    *out++ = ' ';
+    out = write_digits(out, static_cast<unsigned int>(seconds / 3600), 2);
+    *out++ = ':';
+    out = write_digits(out, static_cast<unsigned int>(seconds / 60 % 60), 2);
+    *out++ = ':';
+    out = write_digits(out, static_cast<unsigned int>(seconds % 60), 2);
+    *out = '\0';
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
 DECLSPEC_MANAPE pString timestamp_to_string(boost::uint64_t epoch_timestamp) {
+    char buffer[TIMESTAMP_BUFFER_SIZE];
+    if (format_timestamp(static_cast<boost::int64_t>(epoch_timestamp), buffer)) {
+        return boost::make_shared<std::string>(buffer);
+    }
+
+    // Leave the dates boost::gregorian cannot represent to boost, which reports them.
     static std::locale loc(std::cout.getloc(),
                            new btime::time_facet("%Y-%b-%d %H:%M:%S%F %z"));
     std::stringstream ss;
@@ -159,10 +671,9 @@ DECLSPEC_MANAPE pString timestamp_to_string(boost::uint64_t epoch_timestamp) {
 
 // ----------------------------------------------------------------------------
 
-DECLSPEC_MANAPE pptime dosdate_to_btime(boost::uint32_t dosdate) {
+DECLSPEC_MANAPE boost::int64_t dosdate_to_posix(boost::uint32_t dosdate) {
     if (dosdate == 0) {
-        return boost::make_shared<btime::ptime>(
-            btime::ptime(boost::gregorian::date(1980, 1, 1)));
+        return days_from_civil(1980, 1, 1) * SECONDS_PER_DAY;
     }
 
     boost::uint16_t date = dosdate >> 16;
@@ -177,17 +688,27 @@ DECLSPEC_MANAPE pptime dosdate_to_btime(boost::uint32_t dosdate) {
         second = 59;
     }
 
-    try {
-        return boost::make_shared<btime::ptime>(btime::ptime(
-            boost::gregorian::date(year, month, day),
-            btime::hours(hour) + btime::minutes(minute) + btime::seconds(second)));
-    } catch (std::exception &) {
+    static const boost::uint8_t DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30,
+                                                   31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || day < 1 ||
+        day > DAYS_IN_MONTH[month - 1] + (month == 2 && is_leap_year(year))) {
         PRINT_WARNING << "Tried to convert an invalid DosDate: " << dosdate
                       << ". Falling back to posix timestamp." << DEBUG_INFO << std::endl;
         // Some samples seem to be using a standard epoch timestamp (i.e.
         // be7dc7c927caa47740c369daf35fc5e5). Try falling back to that.
-        return boost::make_shared<btime::ptime>(btime::from_time_t(dosdate));
+        return dosdate;
     }
+
+    // Hours and minutes may overflow into the next day, like they do with boost.
+    return days_from_civil(year, month, day) * SECONDS_PER_DAY + hour * 3600 +
+           minute * 60 + second;
+}
+
+// ----------------------------------------------------------------------------
+
+DECLSPEC_MANAPE pptime dosdate_to_btime(boost::uint32_t dosdate) {
+    return boost::make_shared<btime::ptime>(
+        btime::from_time_t(dosdate_to_posix(dosdate)));
 }
 
 // ----------------------------------------------------------------------------
@@ -212,18 +733,7 @@ DECLSPEC_MANAPE bool is_actually_posix(boost::uint32_t dosdate,
 // ----------------------------------------------------------------------------
 
 DECLSPEC_MANAPE pString dosdate_to_string(boost::uint32_t dosdate) {
-    static std::locale loc(std::cout.getloc(),
-                           new btime::time_facet("%Y-%b-%d %H:%M:%S%F %z"));
-    std::stringstream ss;
-    ss.imbue(loc);
-    const auto time = dosdate_to_btime(dosdate);
-    if (time) {
-        ss << *time;
-    } else {
-        ss << boost::posix_time::from_time_t(0) << " (ERROR)";
-    }
-
-    return boost::make_shared<std::string>(ss.str());
+    return timestamp_to_string(dosdate_to_posix(dosdate));
 }
 
 // ----------------------------------------------------------------------------
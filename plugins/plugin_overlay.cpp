@@ -45,15 +45,15 @@ public:
 	{
 		pResult res = create_result();
         
-        const auto overlay_bytes = pe.get_overlay_bytes();
-        if (overlay_bytes == nullptr) {
+        const auto overlay = pe.get_overlay_view();
+        if (overlay.empty()) {
             return res;
         }
 
         res->raise_level(SUSPICIOUS);
         res->set_summary("The file contains overlay data.");
         std::stringstream ss;
-        ss << overlay_bytes->size() << " bytes of data starting at offset 0x" << std::hex << pe.get_filesize() - overlay_bytes->size() << ".";
+        ss << overlay.size() << " bytes of data starting at offset 0x" << std::hex << pe.get_filesize() - overlay.size() << ".";
         res->add_information(ss.str());
 
         // Try to detect the file type of the overlay data.
@@ -61,7 +61,7 @@ public:
 		if (!y.load_rules("yara_rules/magic.yara")) {
 			return res;
 		}
-        yara::const_matches matches = y.scan_bytes(*overlay_bytes);
+        yara::const_matches matches = y.scan_bytes(*overlay.to_vector());
         if (matches && !matches->empty())
         {
             for (size_t i = 0; i < matches->size(); ++i)
@@ -78,7 +78,7 @@ public:
         // No magic found: check the entropy to see if the data is encrypted.
         else 
         {
-            const auto entropy = utils::shannon_entropy(*overlay_bytes);
+            const auto entropy = utils::shannon_entropy(overlay.data(), overlay.size());
             if (entropy > 7.) 
             {
                 res->raise_level(SUSPICIOUS);
@@ -89,7 +89,7 @@ public:
         }
 
         // Look at the ratio of overlay data.
-        const double ratio = static_cast<double>(overlay_bytes->size()) / static_cast<double>(pe.get_filesize());
+        const double ratio = static_cast<double>(overlay.size()) / static_cast<double>(pe.get_filesize());
         if (ratio > .75)
         {
             std::stringstream ss;
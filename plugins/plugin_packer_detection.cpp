@@ -130,26 +130,8 @@ public:
             return;
         }
 
-        // Validate the checksum in the RICH header
-        boost::uint32_t checksum = rich->file_offset;
-        auto bytes = pe.get_raw_bytes(rich->file_offset);
-        // Checksum of the DOS header
-        for (unsigned int i = 0; i < rich->file_offset; ++i)
-        {
-            // Ignore e_lfanew.
-            if (0x3c <= i && i < 0x40) {
-                continue;
-            }
-            checksum += utils::rol32(bytes->at(i), i);
-        }
-        // Checksum of the @comp.ids.
-        for (unsigned int i = 0; i < rich->values.size(); ++i)
-        {
-            auto v = rich->values.at(i);
-            checksum += utils::rol32((std::get<0>(v) << 16) | std::get<1>(v), std::get<2>(v));
-        }
-
-        if (checksum != rich->xor_key)
+        // Validate the checksum in the RICH header. It is computed while parsing it.
+        if (rich->checksum != rich->xor_key)
         {
             res->raise_level(MALICIOUS);
             if (res->get_summary() == nullptr) {
@@ -206,8 +188,8 @@ public:
 
             // Look for WX sections
             unsigned int characteristics = (*it)->get_characteristics();
-            if (characteristics & nt::SECTION_CHARACTERISTICS.at("IMAGE_SCN_MEM_EXECUTE") &&
-                characteristics & nt::SECTION_CHARACTERISTICS.at("IMAGE_SCN_MEM_WRITE"))
+            if (characteristics & IMAGE_SCN_MEM_EXECUTE &&
+                characteristics & IMAGE_SCN_MEM_WRITE)
             {
                 std::stringstream ss;
                 ss << "Section " << *(*it)->get_name() << " is both writable and executable.";
@@ -56,7 +56,7 @@ public:
     void check_resource_timestamps(const mana::PE& pe, pResult res)
 	{
         const auto r = pe.get_resources();
-        const auto pe_timestamp = boost::posix_time::from_time_t(pe.get_pe_header()->TimeDateStamp);
+        const boost::int64_t pe_timestamp = pe.get_pe_header()->TimeDateStamp;
         auto timestamps = std::set<std::string>();
         auto timezones = std::set<int>();
         for (const auto& it : *r)
@@ -65,23 +65,20 @@ public:
                 continue;
             }
 
-            utils::pptime res_timestamp;
+            boost::int64_t res_timestamp;
             // Some compilers seem to use posix times as timestamps. Determine which situation we are in.
             if (utils::is_actually_posix(it->get_timestamp(), pe.get_pe_header()->TimeDateStamp)) {
-                res_timestamp = boost::make_shared<btime::ptime>(boost::posix_time::from_time_t(it->get_timestamp()));
+                res_timestamp = it->get_timestamp();
             }
             else {
-                res_timestamp = utils::dosdate_to_btime(it->get_timestamp());
-            }
-            if (!res_timestamp) { // Ignore un-convertable timestamps.
-                continue;
+                res_timestamp = utils::dosdate_to_posix(it->get_timestamp());
             }
 
             // Create a set of timestamps which differ from the one reported in the PE header.
-            auto delta = *res_timestamp - pe_timestamp;
+            const boost::int64_t delta = res_timestamp - pe_timestamp;
             // There might be a slight delta between the PE timestamp and the one found in the resources.
             // Assume nobody will tamper them to fake the compilation date by less than 12 hours.
-            if (delta > btime::hours(12) || delta < btime::hours(-12)) {
+            if (delta > 12 * 3600 || delta < -12 * 3600) {
                 timestamps.insert(*utils::dosdate_to_string(it->get_timestamp()));
             }
 
@@ -89,10 +86,12 @@ public:
             // Could it be that something in the build chain uses local timestamps?
             // Report it if we have a delta of exactly 1-12h.
 
-            auto hours = delta.hours();
+            auto hours = static_cast<int>(delta / 3600);
+            auto minutes = static_cast<int>(delta / 60 % 60);
+            auto seconds = static_cast<int>(delta % 60);
             // There can be a delta of 1 second between the two timestamps, possibly due to delays during the compilation.
             // Account for it by rounding up to the next hour if needed.
-            if (abs(delta.minutes()) == 59 && abs(delta.seconds()) > 50) 
+            if (abs(minutes) == 59 && abs(seconds) > 50) 
             {
                 if (hours < 0) {
                     hours -= 1;
@@ -105,7 +104,7 @@ public:
             if (hours != 0 && abs(hours) <= 12 &&
                 timezones.find(hours) == timezones.end())
             {
-                if (abs(delta.minutes()) == 59 || abs(delta.minutes()) <= 1) {
+                if (abs(minutes) == 59 || abs(minutes) <= 1) {
                     std::stringstream ss;
                     ss << "The binary may have been compiled on a machine in the UTC" << std::showpos << hours << " timezone.";
                     res->add_information(ss.str());
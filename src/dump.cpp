@@ -189,7 +189,8 @@ void dump_section_table(const mana::PE& pe, io::OutputFormatter& formatter, bool
 		}
 		if (compute_hashes)
 		{
-			const_shared_strings hashes = hash::hash_bytes(hash::ALL_DIGESTS, *section->get_raw_data());
+			pe::ByteView view = section->get_raw_view();
+			const_shared_strings hashes = hash::hash_bytes(hash::ALL_DIGESTS, view.data(), view.size());
 			section_node->append(boost::make_shared<io::OutputTreeNode>("MD5", hashes->at(ALL_DIGESTS_MD5)));
 			section_node->append(boost::make_shared<io::OutputTreeNode>("SHA1", hashes->at(ALL_DIGESTS_SHA1)));
 			section_node->append(boost::make_shared<io::OutputTreeNode>("SHA256", hashes->at(ALL_DIGESTS_SHA256)));
@@ -204,7 +205,8 @@ void dump_section_table(const mana::PE& pe, io::OutputFormatter& formatter, bool
 		section_node->append(boost::make_shared<io::OutputTreeNode>("NumberOfLineNumbers", section->get_number_of_line_numbers()));
 		section_node->append(boost::make_shared<io::OutputTreeNode>("NumberOfRelocations", section->get_number_of_relocations()));
 		section_node->append(boost::make_shared<io::OutputTreeNode>("Characteristics", *nt::translate_to_flags(section->get_characteristics(), nt::SECTION_CHARACTERISTICS)));
-		if (section->get_size_of_raw_data()) {
+		// The entropy is computed over the whole section, which triage mode must not read.
+		if (section->get_size_of_raw_data() && pe.get_parse_mode() == pe::PE::FULL) {
 			section_node->append(boost::make_shared<io::OutputTreeNode>("Entropy", section->get_entropy()));
 		}
 
@@ -314,7 +316,8 @@ void dump_resources(const mana::PE& pe, io::OutputFormatter& formatter, bool com
 
 		if (compute_hashes)
 		{
-			const_shared_strings hashes = hash::hash_bytes(hash::ALL_DIGESTS, *it->get_raw_data());
+			pe::ByteView view = it->get_raw_view();
+			const_shared_strings hashes = hash::hash_bytes(hash::ALL_DIGESTS, view.data(), view.size());
 			res->append(boost::make_shared<io::OutputTreeNode>("MD5", hashes->at(ALL_DIGESTS_MD5)));
 			res->append(boost::make_shared<io::OutputTreeNode>("SHA1", hashes->at(ALL_DIGESTS_SHA1)));
 			res->append(boost::make_shared<io::OutputTreeNode>("SHA256", hashes->at(ALL_DIGESTS_SHA256)));
@@ -365,10 +368,10 @@ void dump_version_info(const mana::PE& pe, io::OutputFormatter& formatter)
 			key_values->append(boost::make_shared<io::OutputTreeNode>("FileFlags", *nt::translate_to_flags(vi->Value->FileFlags & vi->Value->FileFlagsMask, nt::FIXEDFILEINFO_FILEFLAGS)));
 			key_values->append(boost::make_shared<io::OutputTreeNode>("FileOs", *nt::translate_to_flags(vi->Value->FileOs, nt::FIXEDFILEINFO_FILEOS)));
 			key_values->append(boost::make_shared<io::OutputTreeNode>("FileType", *nt::translate_to_flag(vi->Value->FileType, nt::FIXEDFILEINFO_FILETYPE)));
-			if (vi->Value->FileType == nt::FIXEDFILEINFO_FILETYPE.at("VFT_DRV")) {
+			if (vi->Value->FileType == VFT_DRV) {
 				key_values->append(boost::make_shared<io::OutputTreeNode>("FileSubtype", *nt::translate_to_flag(vi->Value->FileSubtype, nt::FIXEDFILEINFO_FILESUBTYPE_DRV)));
 			}
-			else if (vi->Value->FileType == nt::FIXEDFILEINFO_FILETYPE.at("VFT_FONT")) {
+			else if (vi->Value->FileType == VFT_FONT) {
 				key_values->append(boost::make_shared<io::OutputTreeNode>("FileSubtype", *nt::translate_to_flag(vi->Value->FileSubtype, nt::FIXEDFILEINFO_FILESUBTYPE_FONT)));
 			}
 
@@ -657,11 +660,16 @@ void dump_rich_header(const mana::PE& pe, io::OutputFormatter& formatter)
 
 	io::pNode rich_node(new io::OutputTreeNode("RICH Header", io::OutputTreeNode::LIST));
 	rich_node->append(boost::make_shared<io::OutputTreeNode>("XOR Key", rich->xor_key, io::OutputTreeNode::HEX));
+	std::stringstream hash;
+	hash << std::hex << std::setw(16) << std::setfill('0') << rich->fnv_hash;
+	// Not the RichPE hash: see rich_header::fnv_hash.
+	rich_node->append(boost::make_shared<io::OutputTreeNode>("FNV-1a Hash", hash.str()));
 	for (auto it = rich->values.begin() ; it != rich->values.end() ; ++it)
 	{
 		std::stringstream ss;
-		if (nt::COMP_ID_TYPE.find(std::get<0>(*it)) != nt::COMP_ID_TYPE.end()) {
-			ss << nt::COMP_ID_TYPE.at(std::get<0>(*it));
+		const char* type = nt::COMP_ID_TYPE.find(std::get<0>(*it));
+		if (type != nullptr) {
+			ss << type;
 		}
 		else {
 			ss << std::get<0>(*it);
@@ -669,9 +677,9 @@ void dump_rich_header(const mana::PE& pe, io::OutputFormatter& formatter)
 
 		if (std::get<1>(*it) != 0)
 		{
-			auto s = *nt::translate_to_flag(std::get<1>(*it), nt::COMP_ID_PRODID);
-			if (s.find("UNKNOWN") != 0) {
-				ss << " (" << s << ")";
+			const char* prodid = nt::COMP_ID_PRODID.find(std::get<1>(*it));
+			if (prodid != nullptr) {
+				ss << " (" << prodid << ")";
 			}
 			else {
 				ss << " (" << std::get<1>(*it) << ")";
@@ -699,6 +707,32 @@ void dump_hashes(const mana::PE& pe, io::OutputFormatter& formatter)
 
 // ----------------------------------------------------------------------------
 
+void dump_truncation(const mana::PE& pe, io::OutputFormatter& formatter)
+{
+	if (!pe.is_truncated()) {
+		return;
+	}
+
+	pe::truncation t = pe.get_truncation();
+	std::vector<std::string> reasons;
+	if (t.reasons & pe::truncation::BYTES) {
+		reasons.push_back("Too much data read");
+	}
+	if (t.reasons & pe::truncation::ENTRIES) {
+		reasons.push_back("Too many entries");
+	}
+	if (t.reasons & pe::truncation::DEADLINE) {
+		reasons.push_back("Deadline exceeded");
+	}
+
+	io::pNode truncation_node(new io::OutputTreeNode("Truncation", io::OutputTreeNode::LIST));
+	truncation_node->append(boost::make_shared<io::OutputTreeNode>("Reasons", reasons, io::OutputTreeNode::AFTER_NAME));
+	truncation_node->append(boost::make_shared<io::OutputTreeNode>("Incomplete directories", t.directories));
+	formatter.add_data(truncation_node, *pe.get_path());
+}
+
+// ----------------------------------------------------------------------------
+
 yara::const_matches detect_filetype(mana::pResource r)
 {
 	yara::pYara y = yara::Yara::create();
@@ -719,7 +753,7 @@ yara::const_matches detect_filetype(mana::pResource r)
 
 // ----------------------------------------------------------------------------
 
-bool extract_resources(const mana::PE& pe, const std::string& destination_folder)
+bool extract_resources(const mana::PE& pe, const std::string& destination_folder, pe::BackgroundWriter* writer)
 {
 	if (!bfs::exists(destination_folder) && !bfs::create_directory(destination_folder))
 	{
@@ -733,6 +767,19 @@ bool extract_resources(const mana::PE& pe, const std::string& destination_folder
 	if (resources == nullptr) {
 		return true;
 	}
+	auto icons = boost::make_shared<pe::IconIndex>(*resources);
+
+	// The files are written by the background writer if there is one. Jobs only hold
+	// references to the resources, which keep the underlying file alive.
+	auto write = [&res, writer](const pe::BackgroundWriter::job& job)
+	{
+		if (writer != nullptr) {
+			writer->submit(job);
+		}
+		else {
+			res &= job();
+		}
+	};
 
 	for (const auto& it : *resources)
 	{
@@ -741,17 +788,19 @@ bool extract_resources(const mana::PE& pe, const std::string& destination_folder
 		if (*it->get_type() == "RT_GROUP_ICON" || *it->get_type() == "RT_GROUP_CURSOR")
 		{
 			ss << base << "_" << *it->get_name() << "_" << *it->get_type() << ".ico";
-			res &= it->icon_extract(bfs::path(destination_folder) / bfs::path(ss.str()), *pe.get_resources());
+			destination_file = bfs::path(destination_folder) / bfs::path(ss.str());
+			write([it, destination_file, icons]() { return it->icon_extract(destination_file, *icons); });
+			continue;
 		}
 		else if (*it->get_type() == "RT_MANIFEST")
 		{
 			ss << base << "_" << *it->get_name() << "_RT_MANIFEST.xml";
-			res &= it->extract(bfs::path(destination_folder) / bfs::path(ss.str()));
+			destination_file = bfs::path(destination_folder) / bfs::path(ss.str());
 		}
 		else if (*it->get_type() == "RT_BITMAP")
 		{
 			ss << base << "_" << *it->get_name() << "_RT_BITMAP.bmp";
-			res &= it->extract(bfs::path(destination_folder) / bfs::path(ss.str()));
+			destination_file = bfs::path(destination_folder) / bfs::path(ss.str());
 		}
 		else if (*it->get_type() == "RT_ICON" || *it->get_type() == "RT_CURSOR" || *it->get_type() == "RT_VERSION") {
 			// Ignore the following resource types: we don't want to extract them.
@@ -759,9 +808,9 @@ bool extract_resources(const mana::PE& pe, const std::string& destination_folder
 		}
 		else if (*it->get_type() == "RT_STRING")
 		{
-			// Append all the strings to the same file.
+			// Append all the strings to the same file. Jobs run in order, so the strings
+			// are still written in the order of the resources.
 			destination_file = bfs::path(destination_folder) / bfs::path(base + "_RT_STRINGs.txt");
-			res &= it->extract(destination_file.string());
 		}
 		else // General case
 		{
@@ -775,9 +824,9 @@ bool extract_resources(const mana::PE& pe, const std::string& destination_folder
 			else {
 				ss << "_" << *it->get_type() << ".raw";
 			}
-
-			res &= it->extract(bfs::path(destination_folder) / bfs::path(ss.str()));
+			destination_file = bfs::path(destination_folder) / bfs::path(ss.str());
 		}
+		write([it, destination_file]() { return it->extract(destination_file); });
 	}
 	return res;
 }
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include "dump.h"
 #include "manacommons/color.h"
 #include "manacommons/plugin_framework/plugin_manager.h"
+#include "manape/file_writer.h"
 #include "manape/pe.h"
 #include "output_formatter.h"
 #include "portability.h"
@@ -156,6 +158,34 @@ bool validate_args(po::variables_map &vm, po::options_description &desc, char **
         }
     }
 
+    // Triage mode only gives access to the headers and the section table.
+    if (vm.count("triage")) {
+        if (vm.count("plugins") || vm.count("extract") || vm.count("hashes")) {
+            print_help(desc, argv[0]);
+            std::cout << std::endl;
+            PRINT_ERROR << "--triage cannot be combined with --plugins, --extract or "
+                           "--hashes!"
+                        << std::endl;
+            return false;
+        }
+        if (vm.count("dump")) {
+            std::vector<std::string> selected_categories =
+                tokenize_args(vm["dump"].as<std::vector<std::string>>());
+            const std::vector<std::string> header_categories =
+                boost::assign::list_of("summary")("dos")("pe")("opt")("sections");
+            for (const auto &it : selected_categories) {
+                if (std::find(header_categories.begin(), header_categories.end(), it) ==
+                    header_categories.end()) {
+                    print_help(desc, argv[0]);
+                    std::cout << std::endl;
+                    PRINT_ERROR << "category " << it
+                                << " is not available in triage mode!" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
     // Verify that the requested plugins exist
     if (vm.count("plugins")) {
         std::vector<std::string> selected_plugins =
@@ -238,7 +268,21 @@ bool parse_args(po::variables_map &vm, int argc, char **argv) {
         "Extract the PE resources and authenticode certificates "
         "to the target directory.")(
         "plugins,p", po::value<std::vector<std::string>>(),
-        "Analyze the binary with additional plugins. (may slow down the analysis!)");
+        "Analyze the binary with additional plugins. (may slow down the analysis!)")(
+        "triage,t",
+        "Only parse the PE headers and the section table. Much faster when scanning "
+        "large collections of files, but only the summary, dos, pe, opt and sections "
+        "categories are available.")(
+        "max-bytes", po::value<boost::uint64_t>(),
+        "The number of bytes which may be read from each file while parsing it "
+        "(0 for no limit).")(
+        "max-entries", po::value<boost::uint32_t>(),
+        "The number of entries which may be read from a single directory "
+        "(0 for no limit).")(
+        "max-duration", po::value<boost::uint32_t>(),
+        "How long the parsing of each file may take, in milliseconds "
+        "(0 for no limit). Files exceeding one of these limits are reported as "
+        "truncated.");
 
     po::positional_options_description p;
     p.add("pe", -1);
@@ -485,16 +529,44 @@ std::set<std::string> get_input_files(po::variables_map &vm) {
 
 // ----------------------------------------------------------------------------
 
+/**
+ *	@brief	Builds the parsing limits requested on the command line. Limits which were
+ *			not specified keep their default value.
+ *
+ *	@param	po::variables_map& vm The (parsed) arguments of the application.
+ *
+ *	@return	The limits applied to each analyzed file.
+ */
+mana::pe::parse_limits get_parse_limits(po::variables_map &vm) {
+    mana::pe::parse_limits limits;
+    if (vm.count("max-bytes")) {
+        limits.max_bytes = vm["max-bytes"].as<boost::uint64_t>();
+    }
+    if (vm.count("max-entries")) {
+        limits.max_entries = vm["max-entries"].as<boost::uint32_t>();
+    }
+    if (vm.count("max-duration")) {
+        limits.max_duration = vm["max-duration"].as<boost::uint32_t>();
+    }
+    return limits;
+}
+
+// ----------------------------------------------------------------------------
+
 /**
  *	@brief	Does the actual analysis
  */
 void perform_analysis(const std::string &path, po::variables_map &vm,
+                      const mana::pe::parse_limits &limits,
                       const std::string &extraction_directory,
+                      mana::pe::BackgroundWriter *writer,
                       const std::vector<std::string> &selected_categories,
                       const std::vector<std::string> &selected_plugins,
                       const config &conf,
                       boost::shared_ptr<mana::io::OutputFormatter> formatter) {
-    mana::pe::PE pe(path);
+    mana::pe::PE pe(path,
+                    vm.count("triage") ? mana::pe::PE::HEADERS_ONLY : mana::pe::PE::FULL,
+                    limits);
 
     // Try to parse the PE
     if (!pe.is_valid()) {
@@ -524,7 +596,7 @@ void perform_analysis(const std::string &path, po::variables_map &vm,
 
     if (vm.count("extract")) // Extract resources if requested
     {
-        mana::extract_resources(pe, extraction_directory);
+        mana::extract_resources(pe, extraction_directory, writer);
         mana::extract_authenticode_certificates(pe, extraction_directory);
     }
 
@@ -535,6 +607,9 @@ void perform_analysis(const std::string &path, po::variables_map &vm,
     if (vm.count("plugins")) {
         handle_plugins_option(*formatter, selected_plugins, conf, pe);
     }
+
+    // Last, since the previous steps may have triggered the parsing of directories.
+    mana::dump_truncation(pe, *formatter);
 }
 
 // ----------------------------------------------------------------------------
@@ -573,8 +648,12 @@ int main(int argc, char **argv) {
 
     // Get all the paths now and make them absolute before changing the working directory
     std::set<std::string> targets = get_input_files(vm);
+    mana::pe::parse_limits limits = get_parse_limits(vm);
+    // Extracted files are written on a separate thread while the next files are analyzed.
+    std::unique_ptr<mana::pe::BackgroundWriter> writer;
     if (vm.count("extract")) {
         extraction_directory = bfs::absolute(vm["extract"].as<std::string>()).string();
+        writer.reset(new mana::pe::BackgroundWriter());
     }
     // Break complex arguments into a list once and for all.
     if (vm.count("plugins")) {
@@ -600,8 +679,8 @@ int main(int argc, char **argv) {
     // Do the actual analysis on all the input files
     unsigned int count = 0;
     for (const auto &it : targets) {
-        perform_analysis(it, vm, extraction_directory, selected_categories,
-                         selected_plugins, conf, formatter);
+        perform_analysis(it, vm, limits, extraction_directory, writer.get(),
+                         selected_categories, selected_plugins, conf, formatter);
         if (++count % 1000 == 0) {
             formatter->format(
                 std::cout, false); // Flush the formatter from time to time, to avoid
@@ -610,6 +689,11 @@ int main(int argc, char **argv) {
     }
 
     formatter->format(std::cout);
+    if (writer != nullptr && !writer->wait()) { // Wait for the pending extractions.
+        PRINT_WARNING << "Some files could not be extracted to " << extraction_directory
+                      << "." << std::endl;
+    }
+    writer.reset();
 
     if (vm.count("plugins")) {
         // Explicitly unload the plugins
@@ -0,0 +1,121 @@
+/*
+	This file is part of Manalyze.
+
+	Manalyze is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Manalyze is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "fixtures.h"
+#include "manape/pe.h"
+
+// These tests are meant to be run with ThreadSanitizer (cmake -DTESTS=ON -DTSAN=ON, then
+// TSAN_OPTIONS="suppressions=test/tsan.supp"). Without it, they still verify that
+// concurrent readers observe consistent results.
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Queries most of the PE's information through its public getters, and
+ *			summarizes it in a string which can be compared across threads.
+ */
+std::string query_getters(const mana::pe::PE& pe)
+{
+	std::stringstream ss;
+
+	auto dlls = pe.get_imported_dlls();
+	for (const auto& dll : *dlls)
+	{
+		ss << dll << ":" << pe.get_imported_functions(dll)->size() << ";";
+	}
+	ss << pe.find_imports(".*Process.*", ".*")->size() << ";";
+	ss << pe.find_imported_dlls("kernel32.dll")->size() << ";";
+
+	auto sections = pe.get_sections();
+	for (const auto& section : *sections)
+	{
+		ss << *section->get_name() << "=" << section->get_entropy() << ";";
+	}
+
+	auto resources = pe.get_resources();
+	for (const auto& r : *resources)
+	{
+		auto view = r->get_raw_view();
+		ss << *r->get_type() << ":" << view.size() << ":"
+		   << mana::utils::shannon_entropy(view.data(), view.size()) << ";";
+	}
+
+	ss << pe.get_exports()->size() << ";";
+	ss << pe.get_debug_info()->size() << ";";
+	ss << pe.get_relocation_table()->size() << ";";
+	ss << pe.get_certificates()->size() << ";";
+	ss << (pe.get_tls() ? pe.get_tls()->Callbacks.size() : 0) << ";";
+	ss << (pe.get_config() ? pe.get_config()->SecurityCookie : 0) << ";";
+	ss << (pe.get_delay_load_table() ? pe.get_delay_load_table()->NameStr : "") << ";";
+	ss << (pe.get_rich_header() ? pe.get_rich_header()->values.size() : 0) << ";";
+	ss << pe.get_overlay_view().size() << ";";
+	ss << pe.get_raw_view()[0] << pe.get_raw_view()[1];
+	return ss.str();
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ *	@brief	Runs query_getters() on a single PE object from many threads at once, and
+ *			checks that every thread obtained the same results as a sequential run.
+ */
+void stress_test(const std::string& path)
+{
+	const unsigned int THREADS = 16;
+	const std::string expected = query_getters(mana::pe::PE(path));
+
+	for (unsigned int round = 0 ; round < 10 ; ++round)
+	{
+		// A new object for every round, so that the lazy parsing of the directories
+		// happens while the threads are competing.
+		mana::pe::PE pe(path);
+		BOOST_REQUIRE(pe.is_valid());
+		std::vector<std::string> results(THREADS);
+		std::vector<std::thread> threads;
+		for (unsigned int i = 0 ; i < THREADS ; ++i) {
+			threads.emplace_back([&pe, &results, i]() { results[i] = query_getters(pe); });
+		}
+		for (auto& t : threads) {
+			t.join();
+		}
+		for (const auto& r : results) {
+			BOOST_CHECK_EQUAL(r, expected);
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+BOOST_FIXTURE_TEST_SUITE(concurrency, SetWorkingDirectory)
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(concurrent_getters)
+{
+	stress_test("testfiles/manatest.exe");
+	stress_test("testfiles/manatest2.exe");
+	stress_test("testfiles/manatest3.exe");
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,258 @@
+/*
+This file is part of Manalyze.
+
+Manalyze is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Manalyze is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+
+#include <boost/test/unit_test.hpp>
+#include "fixtures.h"
+#include "manape/byte_view.h"
+#include "manape/file_buffer.h"
+#include "manape/file_cursor.h"
+#include "manape/file_writer.h"
+
+BOOST_FIXTURE_TEST_SUITE(file_buffer, SetupFiles)
+
+BOOST_AUTO_TEST_CASE(file_buffer_open)
+{
+	auto f = mana::pe::FileBuffer::open("fox");
+	BOOST_ASSERT(f);
+	BOOST_CHECK(f->is_mapped());
+	BOOST_CHECK_EQUAL(f->size(), 43);
+	BOOST_CHECK(memcmp(f->data(), "The quick", 9) == 0);
+
+	BOOST_CHECK(!mana::pe::FileBuffer::open("nonexistent_file"));
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(file_buffer_empty)
+{
+	// Empty files cannot be mapped but must still be usable.
+	auto f = mana::pe::FileBuffer::open("empty");
+	BOOST_ASSERT(f);
+	BOOST_CHECK(!f->is_mapped());
+	BOOST_CHECK_EQUAL(f->size(), 0);
+	char c;
+	BOOST_CHECK_EQUAL(f->read(0, &c, 1), 0);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(file_cursor_reads)
+{
+	mana::pe::FileCursor cursor(mana::pe::FileBuffer::open("fox"));
+	char buffer[16] = {0};
+
+	BOOST_CHECK_EQUAL(cursor.read(buffer, 3), 3);
+	BOOST_CHECK(std::string(buffer, 3) == "The");
+	BOOST_CHECK_EQUAL(cursor.tell(), 3);
+	BOOST_CHECK(cursor.skip(1));
+	BOOST_CHECK_EQUAL(cursor.read(buffer, 5), 5);
+	BOOST_CHECK(std::string(buffer, 5) == "quick");
+
+	// Reads are truncated at the end of the file.
+	BOOST_CHECK(cursor.seek(40));
+	BOOST_CHECK_EQUAL(cursor.read(buffer, 16), 3);
+	BOOST_CHECK(std::string(buffer, 3) == "dog");
+	BOOST_CHECK(cursor.eof());
+
+	// Seeking outside of the file fails and leaves the cursor untouched.
+	BOOST_CHECK(!cursor.seek(44));
+	BOOST_CHECK(!cursor.skip(-50));
+	BOOST_CHECK_EQUAL(cursor.tell(), 43);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(file_cursor_typed_reads)
+{
+	const boost::uint8_t bytes[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+									 0xAA, 0xBB, 0xCC, 0xDD, 0xEE };
+	mana::pe::FileCursor cursor(mana::pe::FileBuffer::from_memory(bytes, sizeof(bytes)));
+
+	boost::uint16_t u16 = 0;
+	boost::uint32_t u32 = 0;
+	boost::uint64_t u64 = 0;
+	BOOST_CHECK(cursor.read_le(u16));
+	BOOST_CHECK_EQUAL(u16, 0x0201);
+	BOOST_CHECK(cursor.read_le(u32));
+	BOOST_CHECK_EQUAL(u32, 0x06050403u);
+	BOOST_CHECK(cursor.read_le(u64, 4)); // PE32 field stored in a uint64
+	BOOST_CHECK_EQUAL(u64, 0xBBAA0807u);
+
+	// Reads which do not fit leave the value and the cursor untouched.
+	BOOST_CHECK(!cursor.read_le(u32));
+	BOOST_CHECK_EQUAL(u32, 0x06050403u);
+	BOOST_CHECK_EQUAL(cursor.tell(), 10);
+	BOOST_CHECK(!cursor.read_le(u16, 3));
+
+	std::vector<boost::uint16_t> array;
+	BOOST_CHECK(cursor.at(0).read_array(array, 4));
+	BOOST_CHECK_EQUAL(array.size(), 4);
+	BOOST_CHECK_EQUAL(array[3], 0x0807);
+	BOOST_CHECK(!cursor.at(0).read_array(array, 0x80000000)); // Not allocated
+	BOOST_CHECK_EQUAL(cursor.tell(), 10); // at() did not move the cursor
+
+	auto view = cursor.view(100);
+	BOOST_CHECK_EQUAL(view.size(), 3);
+	BOOST_CHECK(view.data() == bytes + 10);
+	BOOST_CHECK(cursor.eof());
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(file_cursor_subrange)
+{
+	mana::pe::FileCursor cursor(mana::pe::FileBuffer::open("fox"));
+	char buffer[16] = {0};
+
+	auto brown = cursor.subrange(10, 5);
+	BOOST_CHECK_EQUAL(brown.tell(), 10);
+	BOOST_CHECK_EQUAL(brown.remaining(), 5);
+	BOOST_CHECK_EQUAL(brown.read(buffer, 16), 5); // Reads stop at the end of the range
+	BOOST_CHECK(std::string(buffer, 5) == "brown");
+	BOOST_CHECK(!brown.seek(16));
+	BOOST_CHECK(!brown.seek(9));
+	BOOST_CHECK(brown.seek(10));
+
+	// Sub-ranges cannot be bigger than their parent.
+	auto nested = brown.subrange(12, 100);
+	BOOST_CHECK_EQUAL(nested.remaining(), 3);
+	BOOST_CHECK(brown.at(4).eof());
+	BOOST_CHECK(cursor.subrange(50, 1).eof());
+	BOOST_CHECK_EQUAL(cursor.tell(), 0);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(byte_view)
+{
+	auto f = mana::pe::FileBuffer::open("fox");
+	mana::pe::ByteView view(f, 4, 100);
+	BOOST_CHECK_EQUAL(view.size(), 39); // Truncated at the end of the file
+	BOOST_CHECK(view.data() == f->data() + 4); // No copy was made
+	BOOST_CHECK(std::string(view.begin(), view.begin() + 5) == "quick");
+
+	auto sub = view.subview(6, 5);
+	BOOST_CHECK(std::string(sub.begin(), sub.end()) == "brown");
+	BOOST_CHECK(view.subview(39, 1).empty());
+
+	auto copy = view.to_vector();
+	BOOST_CHECK_EQUAL(copy->size(), 39);
+	BOOST_CHECK_EQUAL(copy->at(0), 'q');
+
+	BOOST_CHECK(mana::pe::ByteView(f, 43, 1).empty());
+	BOOST_CHECK(mana::pe::ByteView(nullptr, 0, 1).empty());
+	BOOST_CHECK_EQUAL(sub.get_offset(), 10);
+	BOOST_CHECK(sub.get_file() == f);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(write_to_file)
+{
+	// A file big enough to be copied by the kernel.
+	std::vector<boost::uint8_t> bytes(200000);
+	for (size_t i = 0 ; i < bytes.size() ; ++i) {
+		bytes[i] = static_cast<boost::uint8_t>(i * 7);
+	}
+	std::ofstream("big", std::ios::binary).write(reinterpret_cast<const char*>(&bytes[0]), bytes.size());
+
+	auto big = mana::pe::FileBuffer::open("big");
+	BOOST_CHECK_EQUAL(big->get_path(), "big");
+	auto memory = mana::pe::FileBuffer::from_memory(boost::make_shared<std::vector<boost::uint8_t>>(bytes));
+	BOOST_CHECK(memory->get_path().empty());
+
+	std::vector<mana::pe::ByteView> views;
+	views.push_back(mana::pe::ByteView(mana::pe::FileBuffer::open("fox"), 4, 6));
+	views.push_back(mana::pe::ByteView(big, 1000, 150000));
+	views.push_back(mana::pe::ByteView(memory, 100, 100000));
+	BOOST_ASSERT(mana::pe::write_to_file("out", views));
+
+	std::ifstream in("out", std::ios::binary);
+	std::vector<boost::uint8_t> written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+	fs::remove("out");
+	fs::remove("big");
+
+	std::vector<boost::uint8_t> expected(views[0].begin(), views[0].end());
+	expected.insert(expected.end(), bytes.begin() + 1000, bytes.begin() + 151000);
+	expected.insert(expected.end(), bytes.begin() + 100, bytes.begin() + 100100);
+	BOOST_CHECK(written == expected);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(write_to_file_changed_source)
+{
+	std::vector<boost::uint8_t> original(200000, 'A');
+	std::vector<boost::uint8_t> replacement(200000, 'B');
+	std::ofstream("big", std::ios::binary).write(reinterpret_cast<const char*>(&original[0]), original.size());
+	auto big = mana::pe::FileBuffer::open("big");
+	BOOST_CHECK(mana::pe::FileBuffer::from_memory(boost::make_shared<std::vector<boost::uint8_t>>(original))->get_descriptor() == -1);
+
+	// A file of the same size is moved to the same path: the bytes still come from the
+	// file which was analyzed.
+	std::ofstream("big2", std::ios::binary).write(reinterpret_cast<const char*>(&replacement[0]), replacement.size());
+	fs::rename("big2", "big");
+	BOOST_CHECK(big->get_descriptor() != -1);
+	std::vector<mana::pe::ByteView> views(1, mana::pe::ByteView(big, 0, original.size()));
+	BOOST_ASSERT(mana::pe::write_to_file("out", views));
+	std::ifstream in("out", std::ios::binary);
+	std::vector<boost::uint8_t> written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+	BOOST_CHECK(written == original);
+
+	// A file modified after it was mapped is not copied by the kernel.
+	big = mana::pe::FileBuffer::open("big");
+	BOOST_CHECK(big->get_descriptor() != -1);
+	fs::last_write_time("big", fs::last_write_time("big") + 10);
+	BOOST_CHECK(big->get_descriptor() == -1);
+
+	fs::remove("out");
+	fs::remove("big");
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(background_writer)
+{
+	std::atomic<unsigned int> executed(0);
+	mana::pe::BackgroundWriter writer(2);
+	for (unsigned int i = 0 ; i < 100 ; ++i) {
+		writer.submit([&executed, i]() { return executed++ == i; }); // Jobs run in order.
+	}
+	BOOST_CHECK(writer.wait());
+	BOOST_CHECK_EQUAL(executed, 100);
+
+	// Failures are reported once.
+	writer.submit([]() { return false; });
+	writer.submit([]() { return true; });
+	BOOST_CHECK(!writer.wait());
+	BOOST_CHECK(writer.wait());
+
+	// The destructor lets the pending jobs finish.
+	{
+		mana::pe::BackgroundWriter w;
+		w.submit([&executed]() { ++executed; return true; });
+	}
+	BOOST_CHECK_EQUAL(executed, 101);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -141,6 +141,31 @@ BOOST_AUTO_TEST_CASE(hash_imports)
 	BOOST_CHECK(h == "924ac5aa343a9f838d5c16a5d77de2ec");
 }
 
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(translate_ordinals)
+{
+	BOOST_CHECK_EQUAL(*mana::nt::translate_ordinal(3, "WS2_32.dll"), "closesocket");
+	BOOST_CHECK_EQUAL(*mana::nt::translate_ordinal(2, "oleaut32.dll"), "SysAllocString");
+	BOOST_CHECK_EQUAL(*mana::nt::translate_ordinal(1000, "ws2_32.dll"), "#1000");
+	BOOST_CHECK_EQUAL(*mana::nt::translate_ordinal(3, "kernel32.dll"), "#3");
+
+	BOOST_CHECK(mana::nt::find_ordinal_table("kernel32.dll") == nullptr);
+	auto table = mana::nt::find_ordinal_table("WSOCK32.DLL");
+	BOOST_ASSERT(table != nullptr);
+	BOOST_CHECK_EQUAL(table->find(500), std::string("WEP"));
+	BOOST_CHECK(table->find(0) == nullptr);
+
+	// Libraries resolve their ordinal table when they are created.
+	mana::ImportedLibrary library("Ws2_32.dll");
+	mana::import_lookup_table by_ordinal = {};
+	by_ordinal.AddressOfData = 0x80000000 | 23;
+	BOOST_CHECK_EQUAL(library.get_function_name(by_ordinal), "socket");
+	mana::import_lookup_table by_name = {};
+	by_name.Name = "WSAStartup";
+	BOOST_CHECK_EQUAL(library.get_function_name(by_name), "WSAStartup");
+}
+
 // ----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END()
 // ----------------------------------------------------------------------------
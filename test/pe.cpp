@@ -15,7 +15,16 @@
     along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+
 #include <boost/system/api_config.hpp>
+#if defined BOOST_POSIX_API
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
 
 #define BOOST_TEST_MODULE ManalyzeTests
 #if !defined BOOST_WINDOWS_API
@@ -23,6 +32,7 @@
 #endif
 
 #include <boost/test/unit_test.hpp>
+#include <boost/weak_ptr.hpp>
 
 #include "fixtures.h"
 #include "manape/pe.h"
@@ -98,6 +108,333 @@ BOOST_AUTO_TEST_CASE(get_raw_bytes)
 
 // ----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(parse_from_memory)
+{
+	std::ifstream f("testfiles/manatest.exe", std::ios::binary);
+	auto bytes = boost::make_shared<std::vector<boost::uint8_t>>(
+		(std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	BOOST_CHECK_EQUAL(bytes->size(), 16360);
+
+	// Buffer owned by the PE object
+	auto pe = mana::pe::PE::from_memory(bytes, "manatest");
+	BOOST_ASSERT(pe->is_valid());
+	BOOST_CHECK_EQUAL(pe->get_filesize(), 16360);
+	BOOST_CHECK_EQUAL(*pe->get_path(), "manatest");
+
+	mana::pe::PE reference("testfiles/manatest.exe");
+	BOOST_CHECK_EQUAL(pe->get_sections()->size(), reference.get_sections()->size());
+	BOOST_CHECK(*pe->get_imported_dlls() == *reference.get_imported_dlls());
+	BOOST_CHECK_EQUAL(pe->get_resources()->size(), reference.get_resources()->size());
+	BOOST_CHECK(*pe->get_resources()->at(0)->get_raw_data() ==
+				*reference.get_resources()->at(0)->get_raw_data());
+
+	// Borrowed buffer
+	auto pe2 = mana::pe::PE::from_memory(&(*bytes)[0], bytes->size());
+	BOOST_ASSERT(pe2->is_valid());
+	BOOST_CHECK(pe2->get_raw_view().data() == &(*bytes)[0]);
+
+	// Triage mode and parse limits apply to buffers too.
+	auto headers = mana::pe::PE::from_memory(bytes, "", mana::pe::PE::HEADERS_ONLY);
+	BOOST_CHECK(headers->get_parse_mode() == mana::pe::PE::HEADERS_ONLY);
+	BOOST_CHECK(headers->get_imports()->empty());
+	mana::pe::parse_limits limits;
+	limits.max_entries = 1;
+	auto limited = mana::pe::PE::from_memory(&(*bytes)[0], bytes->size(), "", mana::pe::PE::FULL, limits);
+	BOOST_REQUIRE(reference.get_imports()->size() > 1);
+	BOOST_CHECK_EQUAL(limited->get_imports()->size(), 1);
+	BOOST_CHECK(limited->is_truncated());
+
+	// Invalid buffers
+	BOOST_CHECK(!mana::pe::PE::from_memory(shared_bytes())->is_valid());
+	BOOST_CHECK(!mana::pe::PE::from_memory(&(*bytes)[0], 0x40)->is_valid());
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(parse_on_demand)
+{
+	// Directories are parsed the first time they are requested, and only once.
+	mana::pe::PE pe("testfiles/manatest3.exe");
+	BOOST_ASSERT(pe.is_valid());
+
+	// Querying the delay-load table first must also load the regular imports.
+	BOOST_CHECK(pe.get_delay_load_table() != nullptr);
+	auto imports = pe.get_imports();
+	BOOST_ASSERT(imports != nullptr);
+	auto imports2 = pe.get_imports();
+	BOOST_CHECK_EQUAL(imports->size(), imports2->size());
+	BOOST_CHECK(imports->at(0) == imports2->at(0)); // Same objects: no second pass.
+	BOOST_CHECK_EQUAL(pe.find_imports("CryptAcquireContextW")->size(), 1);
+
+	auto resources = pe.get_resources();
+	BOOST_CHECK(resources->at(0) == pe.get_resources()->at(0));
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(shared_snapshots)
+{
+	// Getters return the same immutable object every time instead of a copy.
+	mana::pe::PE pe("testfiles/manatest3.exe");
+	BOOST_CHECK(pe.get_sections() == pe.get_sections());
+	BOOST_CHECK(pe.get_imports() == pe.get_imports());
+	BOOST_CHECK(pe.get_resources() == pe.get_resources());
+	BOOST_CHECK(pe.get_exports() == pe.get_exports());
+	BOOST_CHECK(pe.get_debug_info() == pe.get_debug_info());
+	BOOST_CHECK(pe.get_relocation_table() == pe.get_relocation_table());
+	BOOST_CHECK(pe.get_certificates() == pe.get_certificates());
+	BOOST_CHECK(pe.get_delay_load_table() == pe.get_delay_load_table());
+	BOOST_CHECK(pe.get_config() == pe.get_config());
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(parse_limits)
+{
+	mana::pe::PE reference("testfiles/manatest2.exe");
+	BOOST_ASSERT(reference.get_resources()->size() > 2);
+	BOOST_CHECK(!reference.is_truncated());
+	BOOST_CHECK_EQUAL(reference.get_truncation().reasons, mana::pe::truncation::NONE);
+
+	// Too many entries: the directory is cut short.
+	mana::pe::parse_limits limits;
+	limits.max_entries = 2;
+	mana::pe::PE pe("testfiles/manatest2.exe", mana::pe::PE::FULL, limits);
+	BOOST_ASSERT(pe.is_valid());
+	BOOST_CHECK(!pe.is_truncated()); // Nothing was parsed yet.
+	BOOST_CHECK_EQUAL(pe.get_resources()->size(), 2);
+	BOOST_CHECK(*pe.get_resources()->at(1)->get_type() == *reference.get_resources()->at(1)->get_type());
+	BOOST_CHECK(pe.is_truncated());
+	auto t = pe.get_truncation();
+	BOOST_CHECK_EQUAL(t.reasons, mana::pe::truncation::ENTRIES);
+	BOOST_CHECK(t.directories == std::set<std::string>({"resource table"}));
+
+	// Too many bytes: every directory parsed afterwards is empty.
+	limits = mana::pe::parse_limits();
+	limits.max_bytes = 64;
+	mana::pe::PE pe2("testfiles/manatest2.exe", mana::pe::PE::FULL, limits);
+	BOOST_CHECK(pe2.get_resources()->empty());
+	BOOST_CHECK(pe2.get_imports()->empty());
+	BOOST_CHECK(!pe2.get_sections()->empty()); // Headers are not affected.
+	t = pe2.get_truncation();
+	BOOST_CHECK_EQUAL(t.reasons, mana::pe::truncation::BYTES);
+	BOOST_CHECK_EQUAL(t.directories.size(), 2);
+
+	// Deadline: only the time spent parsing counts, not the time between two getters.
+	limits = mana::pe::parse_limits();
+	limits.max_duration = 50;
+	mana::pe::PE pe3("testfiles/manatest2.exe", mana::pe::PE::FULL, limits);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	BOOST_CHECK(!pe3.get_imports()->empty());
+	BOOST_CHECK(!pe3.is_truncated());
+
+	limits.max_duration = 1;
+	mana::pe::ParseBudget budget(limits);
+	{
+		mana::pe::ParseBudget::Timer timer(budget);
+		BOOST_CHECK(budget.consume(1, "import table"));
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		BOOST_CHECK(!budget.consume(1, "import table"));
+	}
+	BOOST_CHECK(!budget.consume(1, "export table"));
+	t = budget.get_truncation();
+	BOOST_CHECK_EQUAL(t.reasons, mana::pe::truncation::DEADLINE);
+	BOOST_CHECK_EQUAL(t.directories.size(), 2);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(structures_outlive_pe)
+{
+	// Parsed structures are allocated in an arena owned by the PE, which must stay
+	// alive for as long as they are referenced.
+	mana::pe::shared_sections sections;
+	mana::pe::shared_resources resources;
+	mana::pe::pImportedLibrary library;
+	{
+		mana::pe::PE pe("testfiles/manatest.exe");
+		sections = pe.get_sections();
+		resources = pe.get_resources();
+		library = pe.get_imports()->at(0);
+	}
+	BOOST_CHECK_EQUAL(*sections->at(0)->get_name(), ".text");
+	BOOST_CHECK(!resources->empty() && !resources->at(0)->get_type()->empty());
+	BOOST_CHECK(!library->get_imports()->empty());
+	BOOST_CHECK(!library->get_name()->empty());
+
+	// The arena is released once the last structure is gone.
+	boost::weak_ptr<mana::pe::Section> weak_section(sections->at(0));
+	boost::weak_ptr<mana::pe::import_lookup_table> weak_import(library->get_imports()->at(0));
+	sections.reset();
+	resources.reset();
+	BOOST_CHECK(!weak_section.expired());
+	library.reset();
+	BOOST_CHECK(weak_section.expired());
+	BOOST_CHECK(weak_import.expired());
+
+	// Arena objects are destroyed along with the arena.
+	auto arena = boost::make_shared<mana::pe::Arena>();
+	auto weak = boost::weak_ptr<mana::pe::Arena>(arena);
+	auto library_name = mana::pe::make_in_arena<std::string>(arena, 100, 'a');
+	auto ex = mana::pe::make_in_arena<mana::pe::exported_function>(arena);
+	BOOST_CHECK_EQUAL(ex->Address, 0);
+	BOOST_CHECK_EQUAL(ex->Ordinal, 0);
+	arena.reset();
+	BOOST_CHECK(!weak.expired());
+	BOOST_CHECK_EQUAL(library_name->size(), 100);
+	library_name.reset();
+	ex.reset();
+	BOOST_CHECK(weak.expired());
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(parse_headers_only)
+{
+	mana::pe::PE pe("testfiles/manatest3.exe", mana::pe::PE::HEADERS_ONLY);
+	mana::pe::PE reference("testfiles/manatest3.exe");
+	BOOST_ASSERT(pe.is_valid());
+	BOOST_CHECK_EQUAL(pe.get_parse_mode(), mana::pe::PE::HEADERS_ONLY);
+	BOOST_CHECK_EQUAL(reference.get_parse_mode(), mana::pe::PE::FULL);
+
+	// Headers and sections are available...
+	BOOST_CHECK_EQUAL(pe.get_pe_header()->TimeDateStamp,
+					  reference.get_pe_header()->TimeDateStamp);
+	BOOST_CHECK_EQUAL(pe.get_image_optional_header()->Subsystem,
+					  reference.get_image_optional_header()->Subsystem);
+	BOOST_CHECK_EQUAL(pe.get_sections()->size(), reference.get_sections()->size());
+	BOOST_CHECK_EQUAL(pe.get_filesize(), reference.get_filesize());
+
+	// ...but the data directories are reported as empty.
+	BOOST_CHECK(pe.get_imports()->empty());
+	BOOST_CHECK(pe.get_imported_dlls()->empty());
+	BOOST_CHECK(pe.get_resources()->empty());
+	BOOST_CHECK(pe.get_delay_load_table() == nullptr);
+	BOOST_CHECK(!reference.get_imported_dlls()->empty());
+	BOOST_CHECK(reference.get_delay_load_table() != nullptr);
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined BOOST_POSIX_API
+BOOST_AUTO_TEST_CASE(headers_only_io)
+{
+	// Triage mode must not read anything past the section table. The file is copied
+	// in memory, and the pages which follow the headers are made inaccessible: any
+	// access to them crashes the test.
+	std::ifstream f("testfiles/manatest3.exe", std::ios::binary);
+	std::vector<char> bytes((std::istreambuf_iterator<char>(f)),
+							std::istreambuf_iterator<char>());
+	const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	BOOST_REQUIRE(bytes.size() > page_size);
+	void* memory = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	BOOST_REQUIRE(memory != MAP_FAILED);
+	memcpy(memory, &bytes[0], bytes.size());
+	auto data = static_cast<boost::uint8_t*>(memory);
+	BOOST_REQUIRE(mprotect(data + page_size, bytes.size() - page_size, PROT_NONE) == 0);
+
+	{
+		mana::pe::PE pe(mana::pe::FileBuffer::from_memory(data, bytes.size()), "manatest3",
+						mana::pe::PE::HEADERS_ONLY);
+		BOOST_REQUIRE(pe.is_valid());
+
+		// Everything the summary and the section dump query in triage mode.
+		BOOST_CHECK(pe.get_dos_header());
+		BOOST_CHECK(pe.get_pe_header());
+		BOOST_CHECK(pe.get_image_optional_header());
+		BOOST_CHECK(pe.get_resources()->empty());
+		BOOST_CHECK(pe.get_debug_info()->empty());
+		BOOST_CHECK(!pe.get_tls());
+		auto sections = pe.get_sections();
+		BOOST_REQUIRE(!sections->empty());
+		BOOST_CHECK(sections->back()->get_pointer_to_raw_data() +
+					sections->back()->get_size_of_raw_data() > page_size);
+		for (const auto& s : *sections)
+		{
+			BOOST_CHECK(s->get_name());
+			BOOST_CHECK(s->get_characteristics() != 0);
+		}
+	}
+	munmap(memory, bytes.size());
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(relocation_table)
+{
+	mana::pe::PE pe("testfiles/manatest.exe");
+	auto table = pe.get_relocation_table();
+	BOOST_REQUIRE(table);
+	BOOST_REQUIRE(!table->empty());
+
+	// Walk the blocks by hand. The table contains every entry, except the padding.
+	std::ifstream f("testfiles/manatest.exe", std::ios::binary);
+	auto bytes = boost::make_shared<std::vector<boost::uint8_t>>(
+		(std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	auto directory = pe.get_image_optional_header()->directories[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+	unsigned int offset = pe.rva_to_offset(directory.VirtualAddress);
+	BOOST_REQUIRE(offset != 0);
+	boost::uint32_t page_rva = 0, block_size = 0;
+	size_t expected = 0, expected_in_first_block = 0;
+	for (unsigned int pos = 0 ; pos < directory.Size ; pos += block_size)
+	{
+		memcpy(&page_rva, &(*bytes)[offset + pos], sizeof(page_rva));
+		memcpy(&block_size, &(*bytes)[offset + pos + 4], sizeof(block_size));
+		if (block_size == 0) {
+			break;
+		}
+		for (unsigned int i = 8 ; i + 1 < block_size ; i += 2) {
+			expected += ((*bytes)[offset + pos + i + 1] >> 4) != 0;
+		}
+		if (pos == 0) {
+			expected_in_first_block = expected;
+		}
+	}
+	BOOST_CHECK_EQUAL(table->size(), expected);
+	BOOST_CHECK(std::is_sorted(table->begin(), table->end(),
+		[](const mana::pe::relocation& a, const mana::pe::relocation& b) {
+			return mana::pe::RelocationTable::get_rva(a) < mana::pe::RelocationTable::get_rva(b);
+		}));
+
+	// x86 relocations patch 4 bytes.
+	auto first = *table->begin();
+	boost::uint32_t rva = mana::pe::RelocationTable::get_rva(first);
+	BOOST_CHECK_EQUAL(first.Type, 3); // IMAGE_REL_BASED_HIGHLOW
+	BOOST_CHECK(!table->is_relocated(rva - 1));
+	BOOST_CHECK(table->is_relocated(rva));
+	BOOST_CHECK(table->is_relocated(rva + 3));
+
+	// Ranges
+	memcpy(&page_rva, &(*bytes)[offset], sizeof(page_rva));
+	auto range = table->find_range(page_rva, page_rva + 0x1000);
+	BOOST_CHECK_EQUAL(std::distance(range.first, range.second), expected_in_first_block);
+	range = table->find_range(0, page_rva);
+	BOOST_CHECK(range.first == range.second);
+
+	// The deprecated block list is rebuilt from the table.
+	auto blocks = pe.get_relocations();
+	BOOST_REQUIRE(blocks && !blocks->empty());
+	BOOST_CHECK_EQUAL(blocks->at(0)->PageRVA, page_rva);
+	BOOST_CHECK_EQUAL(blocks->at(0)->TypesOffsets.size(), expected_in_first_block);
+	BOOST_CHECK_EQUAL(blocks->at(0)->BlockSize, 8 + 2 * expected_in_first_block);
+	size_t in_blocks = 0;
+	for (const auto& block : *blocks) {
+		in_blocks += block->TypesOffsets.size();
+	}
+	BOOST_CHECK_EQUAL(in_blocks, table->size());
+
+	// A block smaller than its header is malformed.
+	(*bytes)[offset + 4] = 4; // BlockSize
+	(*bytes)[offset + 5] = (*bytes)[offset + 6] = (*bytes)[offset + 7] = 0;
+	auto malformed = mana::pe::PE::from_memory(bytes);
+	BOOST_CHECK_EQUAL(malformed->get_relocation_table()->size(), 0);
+	BOOST_CHECK(!malformed->is_truncated());
+}
+
+// ----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_CASE(parse_dos_header)
 {
 	mana::PE pe("testfiles/manatest.exe");
@@ -264,6 +601,27 @@ BOOST_AUTO_TEST_CASE(parse_exports)
 
 // ----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(find_export)
+{
+	mana::pe::PE pe("testfiles/manatest2.exe");
+	auto exported = pe.find_export("exported");
+	BOOST_ASSERT(exported);
+	BOOST_CHECK(exported == pe.get_exports()->at(0));
+	BOOST_CHECK(pe.find_export(1) == exported);
+
+	BOOST_CHECK(pe.find_export("Exported") == nullptr);
+	BOOST_CHECK(pe.find_export("") == nullptr);
+	BOOST_CHECK(pe.find_export(0) == nullptr);
+	BOOST_CHECK(pe.find_export(2) == nullptr);
+
+	// No export directory at all.
+	mana::pe::PE exe("testfiles/manatest.exe");
+	BOOST_CHECK(exe.find_export("exported") == nullptr);
+	BOOST_CHECK(exe.find_export(1) == nullptr);
+}
+
+// ----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_CASE(parse_debug_info)
 {
 	mana::PE pe("testfiles/manatest.exe");
@@ -432,6 +790,37 @@ BOOST_AUTO_TEST_CASE(parse_rich_header)
 	BOOST_CHECK_EQUAL(std::get<0>(rich->values.at(10)), 0x0102);
 	BOOST_CHECK_EQUAL(std::get<1>(rich->values.at(10)), 0x5bd2);
 	BOOST_CHECK_EQUAL(std::get<2>(rich->values.at(10)), 1);
+
+	BOOST_CHECK_EQUAL(rich->checksum, rich->xor_key);
+	BOOST_CHECK_EQUAL(rich->fnv_hash, 0x9423764f0ecaef92);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(flag_tables)
+{
+	// The constants used by the parser must agree with the translation tables.
+	BOOST_CHECK_EQUAL(nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32"), IMAGE_NT_OPTIONAL_HDR32_MAGIC);
+	BOOST_CHECK_EQUAL(nt::IMAGE_OPTIONAL_HEADER_MAGIC.at("PE32+"), IMAGE_NT_OPTIONAL_HDR64_MAGIC);
+	BOOST_CHECK_EQUAL(nt::DEBUG_TYPES.at("IMAGE_DEBUG_TYPE_CODEVIEW"), IMAGE_DEBUG_TYPE_CODEVIEW);
+	BOOST_CHECK_EQUAL(nt::DEBUG_TYPES.at("IMAGE_DEBUG_TYPE_MISC"), IMAGE_DEBUG_TYPE_MISC);
+	BOOST_CHECK_EQUAL(nt::SECTION_CHARACTERISTICS.at("IMAGE_SCN_MEM_EXECUTE"), IMAGE_SCN_MEM_EXECUTE);
+	BOOST_CHECK_EQUAL(nt::SECTION_CHARACTERISTICS.at("IMAGE_SCN_MEM_WRITE"), IMAGE_SCN_MEM_WRITE);
+	BOOST_CHECK_EQUAL(nt::FIXEDFILEINFO_FILETYPE.at("VFT_DRV"), VFT_DRV);
+	BOOST_CHECK_EQUAL(nt::FIXEDFILEINFO_FILETYPE.at("VFT_FONT"), VFT_FONT);
+	BOOST_CHECK_THROW(nt::DEBUG_TYPES.at("IMAGE_DEBUG_TYPE_NONEXISTENT"), std::out_of_range);
+
+	BOOST_CHECK_EQUAL(nt::LANG_IDS.find(0x040c), std::string("French - France"));
+	BOOST_CHECK_EQUAL(nt::COMP_ID_TYPE.find(0x00A), std::string("C objects"));
+	BOOST_CHECK(nt::COMP_ID_TYPE.find(0x0FE) == nullptr);
+	BOOST_CHECK(nt::MACHINE_TYPES.find(0x1234) == nullptr);
+
+	// The tables are enumerated in alphabetical order.
+	for (const auto& table : { nt::LANG_IDS, nt::COMP_ID_PRODID, nt::GLOBAL_FLAGS })
+	{
+		BOOST_CHECK(std::is_sorted(table.begin(), table.end(),
+			[](const nt::flag& a, const nt::flag& b) { return std::string(a.name) < b.name; }));
+	}
 }
 
 // ----------------------------------------------------------------------------
@@ -225,6 +225,9 @@ BOOST_AUTO_TEST_CASE(interpret_versioninfo)
 	check_pair<std::string>(string_table[5], "OriginalFilename", "manatest2.exe");
 	check_pair<std::string>(string_table[6], "ProductName", "manatest2.exe");
 	check_pair<std::string>(string_table[7], "ProductVersion", "1.0.0.0");
+
+	// The resource is only parsed once.
+	BOOST_CHECK(resources->at(12)->interpret_as<mana::pversion_info>() == vi);
 }
 
 // ----------------------------------------------------------------------------
@@ -250,6 +253,38 @@ BOOST_AUTO_TEST_CASE(interpret_icon)
 	
 }
 
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(icon_index)
+{
+	mana::PE pe("testfiles/manatest2.exe");
+	auto resources = pe.get_resources();
+	mana::IconIndex index(*resources);
+	BOOST_CHECK_EQUAL(index.get_resource_count(), resources->size());
+
+	unsigned int groups = 0;
+	for (const auto& r : *resources)
+	{
+		if (*r->get_type() != "RT_GROUP_ICON") {
+			continue;
+		}
+		++groups;
+		auto directory = r->interpret_as<mana::pgroup_icon_directory>();
+		BOOST_ASSERT(directory && !directory->Entries.empty());
+		auto icon = index.find(directory->Type, directory->Entries[0]->Id);
+		BOOST_ASSERT(icon);
+		BOOST_CHECK_EQUAL(*icon->get_type(), "RT_ICON");
+		BOOST_CHECK_EQUAL(icon->get_id(), directory->Entries[0]->Id);
+
+		// Same output as the reconstruction which searches the resources itself.
+		auto bytes = mana::reconstruct_icon(directory, index);
+		BOOST_ASSERT(bytes);
+		BOOST_CHECK(*bytes == *mana::reconstruct_icon(directory, *resources));
+	}
+	BOOST_CHECK(groups > 0);
+	BOOST_CHECK(!index.find(2, 1)); // There are no cursors in this file.
+}
+
 // ----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END()
 // ----------------------------------------------------------------------------
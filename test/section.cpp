@@ -145,6 +145,73 @@ BOOST_AUTO_TEST_CASE(find_section)
 	BOOST_CHECK(s == nullptr);
 }
 
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(section_index)
+{
+	// Overlapping sections, a VirtualSize smaller than the SizeOfRawData, an empty
+	// section and one whose end wraps around.
+	const boost::uint32_t layout[][3] = { // VirtualAddress, VirtualSize, SizeOfRawData
+		{ 0x1000, 0x1000, 0x1000 },
+		{ 0x1800, 0x1000, 0x0200 },
+		{ 0x3000, 0x0100, 0x0800 },
+		{ 0x3400, 0x0000, 0x0000 },
+		{ 0x3200, 0x0400, 0x0000 },
+		{ 0xFFFFF000, 0x2000, 0x0000 },
+	};
+	std::vector<mana::pe::pSection> sections;
+	for (const auto& it : layout)
+	{
+		mana::pe::image_section_header h = {0};
+		h.VirtualAddress = it[0];
+		h.VirtualSize = it[1];
+		h.SizeOfRawData = it[2];
+		sections.push_back(boost::make_shared<mana::pe::Section>(h, nullptr, 0));
+	}
+
+	mana::pe::SectionIndex index(sections);
+	for (boost::uint64_t rva = 0 ; rva < 0x5000 ; rva += 0x10) {
+		BOOST_CHECK(index.find(rva) == mana::pe::find_section(rva, sections));
+	}
+	const boost::uint64_t edges[] = { 0xFFF, 0x1000, 0x27FF, 0x2800, 0x30FF, 0x3100,
+									  0x31FF, 0x3200, 0x35FF, 0x3600, 0xFFFFF000,
+									  0xFFFFFFFF, 0x100000000 };
+	for (auto rva : edges) {
+		BOOST_CHECK(index.find(rva) == mana::pe::find_section(rva & 0xFFFFFFFF, sections));
+	}
+
+	// Repeated lookups in the same range go through the last-hit shortcut.
+	BOOST_CHECK(index.find(0x3050) == sections[2]);
+	BOOST_CHECK(index.find(0x3060) == sections[2]);
+	BOOST_CHECK(index.find(0x3150) == sections[2]); // Only matched by SizeOfRawData
+
+	BOOST_CHECK(mana::pe::SectionIndex(std::vector<mana::pe::pSection>()).find(0) == nullptr);
+}
+
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(section_coff_string_table)
+{
+	// Like in MinGW binaries: the table starts with its size and "/N" names point N
+	// bytes into it. The last string is truncated.
+	const char table[] = "\x1d\0\0\0.debug_info\0.debug_line\0.zd";
+	auto file = mana::pe::FileBuffer::from_memory(reinterpret_cast<const boost::uint8_t*>(table), 29);
+	mana::pe::ByteView view(file, 0, 29);
+
+	auto name_of = [&view](const char* name) {
+		mana::pe::image_section_header h = {0};
+		memcpy(h.Name, name, strlen(name));
+		return *mana::pe::Section(h, nullptr, 0, view).get_name();
+	};
+	BOOST_CHECK_EQUAL(name_of("/4"), ".debug_info");
+	BOOST_CHECK_EQUAL(name_of("/16"), ".debug_line");
+	BOOST_CHECK_EQUAL(name_of("/20"), "ug_line");
+	BOOST_CHECK_EQUAL(name_of("/28"), ".");
+	BOOST_CHECK_EQUAL(name_of("/29"), "/29");
+	BOOST_CHECK_EQUAL(name_of("/abc"), "/abc");
+	BOOST_CHECK_EQUAL(name_of(".text"), ".text");
+}
+
 // ----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END()
 // ----------------------------------------------------------------------------
@@ -15,7 +15,11 @@
     along with Manalyze.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cstdio>
+
 #include <boost/test/unit_test.hpp>
+#include "manape/file_buffer.h"
 #include "manape/utils.h"
 
 BOOST_AUTO_TEST_CASE(test_dosdate_to_string)
@@ -43,6 +47,30 @@ BOOST_AUTO_TEST_CASE(test_timestamp_to_string)
     BOOST_CHECK_EQUAL(*date_2, "2004-May-25 13:28:02");
 }
 
+BOOST_AUTO_TEST_CASE(test_format_timestamp)
+{
+    char buffer[mana::utils::TIMESTAMP_BUFFER_SIZE];
+    BOOST_CHECK(mana::utils::format_timestamp(0x40B349E2, buffer));
+    BOOST_CHECK_EQUAL(buffer, "2004-May-25 13:28:02");
+    BOOST_CHECK(mana::utils::format_timestamp(-1, buffer));
+    BOOST_CHECK_EQUAL(buffer, "1969-Dec-31 23:59:59");
+    BOOST_CHECK(mana::utils::format_timestamp(951782400, buffer)); // Leap day
+    BOOST_CHECK_EQUAL(buffer, "2000-Feb-29 00:00:00");
+    BOOST_CHECK(mana::utils::format_timestamp(253402300799, buffer));
+    BOOST_CHECK_EQUAL(buffer, "9999-Dec-31 23:59:59");
+    BOOST_CHECK(!mana::utils::format_timestamp(253402300800, buffer));
+}
+
+BOOST_AUTO_TEST_CASE(test_dosdate_to_posix)
+{
+    BOOST_CHECK_EQUAL(mana::utils::dosdate_to_posix(0), 315532800);
+    BOOST_CHECK_EQUAL(mana::utils::dosdate_to_posix(0x40B349E2), 1337418904);
+    BOOST_CHECK_EQUAL(mana::utils::dosdate_to_posix(0x005D0000), 320630400); // 1980-Feb-29
+    // Invalid dates are interpreted as POSIX timestamps.
+    BOOST_CHECK_EQUAL(mana::utils::dosdate_to_posix(1168460802), 1168460802);
+    BOOST_CHECK_EQUAL(mana::utils::dosdate_to_posix(0x005E0000), 0x005E0000); // 1980-Feb-30
+}
+
 BOOST_AUTO_TEST_CASE(test_is_actually_posix)
 {
     BOOST_CHECK(!utils::is_actually_posix(0, 0x530b3da0));
@@ -50,4 +78,119 @@ BOOST_AUTO_TEST_CASE(test_is_actually_posix)
     BOOST_CHECK(utils::is_actually_posix(0x530b3da3, 0x530b3da0));
     BOOST_CHECK(utils::is_actually_posix(0x530b3d90, 0x530b3da0));
     BOOST_CHECK(!utils::is_actually_posix(0x40b349e2, 0x4fb6e609));
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(test_read_strings)
+{
+    // "kernel32.dll\0", then L"Caf\u00e9 \U0001F600 string\0", then an unterminated "abc".
+    std::string ascii("kernel32.dll\0", 13);
+    std::u16string wide(u"Caf\u00e9 \U0001F600 string");
+    std::vector<boost::uint8_t> bytes(ascii.begin(), ascii.end());
+    for (char16_t c : wide) {
+        bytes.push_back(c & 0xFF);
+        bytes.push_back(c >> 8);
+    }
+    bytes.insert(bytes.end(), { 0, 0, 'a', 'b', 'c' });
+    auto file = mana::pe::FileBuffer::from_memory(bytes.data(), bytes.size());
+    mana::pe::FileCursor cursor(file);
+
+    BOOST_CHECK_EQUAL(mana::utils::read_ascii_string(cursor), "kernel32.dll");
+    BOOST_CHECK_EQUAL(cursor.tell(), 13); // The terminator was consumed
+    BOOST_CHECK_EQUAL(mana::utils::read_unicode_string(cursor),
+                      "Caf\xC3\xA9 \xF0\x9F\x98\x80 string");
+    BOOST_CHECK_EQUAL(cursor.tell(), 13 + 2 * wide.size() + 2);
+    BOOST_CHECK_EQUAL(mana::utils::read_ascii_string(cursor), "abc"); // Stops at EOF
+    BOOST_CHECK(cursor.eof());
+
+    // Maximum sizes
+    cursor.seek(0);
+    BOOST_CHECK_EQUAL(mana::utils::read_ascii_string(cursor, 6), "kernel");
+    BOOST_CHECK_EQUAL(cursor.tell(), 6);
+    cursor.seek(13);
+    BOOST_CHECK_EQUAL(mana::utils::read_unicode_string(cursor, 7), "Caf"); // Rounded down
+    BOOST_CHECK_EQUAL(cursor.tell(), 19);
+
+    // Strings at an offset don't move the cursor.
+    std::string out;
+    BOOST_CHECK(mana::utils::read_string_at_offset(cursor, 6, out));
+    BOOST_CHECK_EQUAL(out, "32.dll");
+    BOOST_CHECK_EQUAL(cursor.tell(), 19);
+
+    // Unpaired surrogates cannot be converted.
+    const boost::uint8_t invalid[] = { 2, 0, 0x3D, 0xD8, 'a', 0 };
+    mana::pe::FileCursor invalid_cursor(
+        mana::pe::FileBuffer::from_memory(invalid, sizeof(invalid)));
+    BOOST_CHECK_EQUAL(mana::utils::read_prefixed_unicode_string(invalid_cursor), "");
+    BOOST_CHECK(invalid_cursor.eof());
+}
+
+BOOST_AUTO_TEST_CASE(test_read_strings_from_file)
+{
+    FILE* f = tmpfile();
+    BOOST_ASSERT(f);
+    const char contents[] = "first\0second\0\x04\0w\0i\0d\0e\0";
+    fwrite(contents, 1, sizeof(contents) - 1, f);
+    rewind(f);
+
+    BOOST_CHECK_EQUAL(mana::utils::read_ascii_string(f), "first");
+    BOOST_CHECK_EQUAL(ftell(f), 6);
+    BOOST_CHECK_EQUAL(mana::utils::read_ascii_string(f, 3), "sec");
+    BOOST_CHECK_EQUAL(ftell(f), 9);
+    BOOST_CHECK_EQUAL(mana::utils::read_ascii_string(f), "ond");
+    BOOST_CHECK_EQUAL(mana::utils::read_prefixed_unicode_string(f), "wide");
+    BOOST_CHECK_EQUAL(ftell(f), sizeof(contents) - 1);
+    fclose(f);
+}
+
+BOOST_AUTO_TEST_CASE(test_find_dword)
+{
+    std::vector<boost::uint8_t> bytes(4 * 37, 0);
+    const boost::uint8_t rich[] = { 'R', 'i', 'c', 'h' };
+    memcpy(&bytes[4 * 35], rich, 4); // After the vectorized part
+    memcpy(&bytes[4 * 9 + 1], rich, 4); // Unaligned: must be ignored
+    BOOST_CHECK_EQUAL(mana::utils::find_dword(&bytes[0], 37, 0x68636952), 35);
+    BOOST_CHECK_EQUAL(mana::utils::find_dword(&bytes[0], 35, 0x68636952), 35);
+
+    memcpy(&bytes[4 * 6], rich, 4);
+    BOOST_CHECK_EQUAL(mana::utils::find_dword(&bytes[0], 37, 0x68636952), 6);
+    BOOST_CHECK_EQUAL(mana::utils::find_dword(&bytes[0], 0, 0x68636952), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_byte_histogram)
+{
+    // Runs of identical bytes take a different path than mixed data.
+    std::vector<boost::uint8_t> bytes(1000, 0xCC);
+    for (size_t i = 300 ; i < bytes.size() ; ++i) {
+        bytes[i] = static_cast<boost::uint8_t>(i * 7 + i / 13);
+    }
+
+    // Every size and alignment around the vector width.
+    for (size_t offset = 0 ; offset < 33 ; ++offset)
+    {
+        for (size_t size = 0 ; size + offset <= bytes.size() ; size += 31)
+        {
+            boost::uint64_t expected[256] = { 0 };
+            for (size_t i = offset ; i < offset + size ; ++i) {
+                ++expected[bytes[i]];
+            }
+            boost::uint64_t histogram[256];
+            mana::utils::byte_histogram(&bytes[offset], size, histogram);
+            BOOST_CHECK(std::equal(histogram, histogram + 256, expected));
+        }
+    }
+
+    // Larger than the internal blocks.
+    std::vector<boost::uint8_t> large((1 << 24) + 100, 0);
+    large[12345] = 1;
+    boost::uint64_t histogram[256];
+    mana::utils::byte_histogram(&large[0], large.size(), histogram);
+    BOOST_CHECK_EQUAL(histogram[0], large.size() - 1);
+    BOOST_CHECK_EQUAL(histogram[1], 1);
+
+    BOOST_CHECK_EQUAL(mana::utils::shannon_entropy(&large[0], 4096), 0.);
+    std::vector<boost::uint8_t> uniform(4096);
+    for (size_t i = 0 ; i < uniform.size() ; ++i) {
+        uniform[i] = static_cast<boost::uint8_t>(i);
+    }
+    BOOST_CHECK_CLOSE(mana::utils::shannon_entropy(uniform), 8., 1e-9);
+}